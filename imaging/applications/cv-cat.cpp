@@ -103,6 +103,8 @@ int main( int argc, char** argv )
         double fps;
         std::string input_options_string;
         std::string output_options_string;
+        double statistics_period;
+        std::string statistics_file;
         boost::program_options::options_description description( "options" );
         description.add_options()
             ( "help,h", "display help message" )
@@ -115,6 +117,8 @@ int main( int argc, char** argv )
             ( "fps", boost::program_options::value< double >( &fps )->default_value( 0 ), "specify max fps ( useful for files, may block if used with cameras ) " )
             ( "input", boost::program_options::value< std::string >( &input_options_string ), "input options, when reading from stdin (see --long-help)" )
             ( "output", boost::program_options::value< std::string >( &output_options_string ), "output options (see --long-help); default: same as --input" )
+            ( "statistics", boost::program_options::value< double >( &statistics_period ), "output per-filter timing statistics as csv every given number of seconds, see --long-help" )
+            ( "statistics-file", boost::program_options::value< std::string >( &statistics_file ), "output statistics to file; default: stderr" )
             ( "stay", "do not close at end of stream" );
         boost::program_options::variables_map vm;
         boost::program_options::store( boost::program_options::parse_command_line( argc, argv, description), vm );
@@ -161,6 +165,8 @@ int main( int argc, char** argv )
                 std::cerr << snark::cv_mat::serialization::options::usage() << std::endl;
                 std::cerr << std::endl;
                 std::cerr << snark::cv_mat::filters::usage() << std::endl;
+                std::cerr << std::endl;
+                std::cerr << snark::imaging::applications::pipeline_statistics::usage() << std::endl;
             }
             std::cerr << std::endl;
             return 1;
@@ -207,7 +213,9 @@ int main( int argc, char** argv )
         {
             reader.reset( new bursty_reader< pair >( boost::bind( &read, boost::ref( input ), boost::ref( rate ) ), discard, defaultCapacity ) );
         }
-        snark::imaging::applications::pipeline pipeline( output, filters, *reader );
+        boost::scoped_ptr< snark::imaging::applications::pipeline_statistics > statistics;
+        if( vm.count( "statistics" ) ) { statistics.reset( new snark::imaging::applications::pipeline_statistics( boost::posix_time::microseconds( statistics_period * 1e6 ), statistics_file ) ); }
+        snark::imaging::applications::pipeline pipeline( output, filters, *reader, statistics.get() );
         pipeline.run();
         if( vm.count( "stay" ) )
         {
@@ -0,0 +1,146 @@
+// This file is part of snark, a generic and flexible library for robotics research
+// Copyright (c) 2011 The University of Sydney
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. All advertising materials mentioning features or use of this software
+//    must display the following acknowledgement:
+//    This product includes software developed by the The University of Sydney.
+// 4. Neither the name of the The University of Sydney nor the
+//    names of its contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+//
+// NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+// GRANTED BY THIS LICENSE.  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+// HOLDERS AND CONTRIBUTORS \"AS IS\" AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+// BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+// OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+// IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifdef WIN32
+#include <winsock2.h>
+#endif
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/lexical_cast.hpp>
+#include <comma/application/command_line_options.h>
+#include <comma/application/signal_flag.h>
+#include <comma/base/exception.h>
+#include <comma/csv/format.h>
+#include <comma/name_value/parser.h>
+#include <snark/imaging/cv_mat/frame_index.h>
+#include <snark/imaging/cv_mat/serialization.h>
+
+static void usage()
+{
+    std::cerr << std::endl;
+    std::cerr << "index recorded images (e.g. cv-cat or gige-cat output) and read them by frame number or time" << std::endl;
+    std::cerr << std::endl;
+    std::cerr << "usage: cv-index <operation> <file> [<options>]" << std::endl;
+    std::cerr << std::endl;
+    std::cerr << "operations" << std::endl;
+    std::cerr << "    make: build index of <file> in a single pass and save it to <file>.index" << std::endl;
+    std::cerr << "    cat: output frames of <file> in the same format, by index ranges or time ranges" << std::endl;
+    std::cerr << "         <file> is memory-mapped; if index file does not exist, it will be built first" << std::endl;
+    std::cerr << std::endl;
+    std::cerr << "options" << std::endl;
+    std::cerr << "    --input=<options>: image serialization options, see cv-cat --help; default: t,rows,cols,type header" << std::endl;
+    std::cerr << "    --index=<filename>: index file; default: <file>.index" << std::endl;
+    std::cerr << "    --output-format: output binary format of index file and exit" << std::endl;
+    std::cerr << "    --verbose,-v: more output" << std::endl;
+    std::cerr << std::endl;
+    std::cerr << "cat options" << std::endl;
+    std::cerr << "    --from=<n>: first frame number; default: 0" << std::endl;
+    std::cerr << "    --to=<n>: frame number to stop at (exclusive); default: end of file" << std::endl;
+    std::cerr << "    --since=<time>: first frame with timestamp not less than <time>" << std::endl;
+    std::cerr << "    --until=<time>: stop at first frame with timestamp not less than <time>" << std::endl;
+    std::cerr << std::endl;
+    std::cerr << "examples" << std::endl;
+    std::cerr << "    cv-index make images.bin" << std::endl;
+    std::cerr << "    cv-index make images.bin --input=\"rows=1000;cols=500;no-header;type=ub\"" << std::endl;
+    std::cerr << "    cv-index cat images.bin --from=1000 --to=2000 | cv-cat \"view\" > /dev/null" << std::endl;
+    std::cerr << "    cv-index cat images.bin --since=20120101T120000 --until=20120101T120500 > five-minutes.bin" << std::endl;
+    std::cerr << "    csv-from-bin $( cv-index --output-format ) < images.bin.index" << std::endl;
+    std::cerr << std::endl;
+    exit( 1 );
+}
+
+int main( int ac, char** av )
+{
+    try
+    {
+        comma::command_line_options options( ac, av );
+        if( options.exists( "--help,-h" ) ) { usage(); }
+        if( options.exists( "--output-format" ) ) { std::cout << comma::csv::format::value< snark::cv_mat::frame_index::entry >() << std::endl; return 0; }
+        bool verbose = options.exists( "--verbose,-v" );
+        std::vector< std::string > unnamed = options.unnamed( "--verbose,-v", "--input,--index,--from,--to,--since,--until" );
+        if( unnamed.size() != 2 ) { std::cerr << "cv-index: expected operation and file name; got " << unnamed.size() << " unnamed parameter(s)" << std::endl; return 1; }
+        const std::string& operation = unnamed[0];
+        const std::string& filename = unnamed[1];
+        snark::cv_mat::serialization::options input_options = comma::name_value::parser( ';', '=' ).get< snark::cv_mat::serialization::options >( options.value< std::string >( "--input", "" ) );
+        std::string index_filename = options.value( "--index", snark::cv_mat::frame_index::filename( filename ) );
+        if( operation == "make" )
+        {
+            std::ifstream ifs( filename.c_str(), std::ios::binary );
+            if( !ifs.is_open() ) { std::cerr << "cv-index: failed to open \"" << filename << "\"" << std::endl; return 1; }
+            snark::cv_mat::frame_index index = snark::cv_mat::frame_index::make( ifs, input_options );
+            index.save( index_filename );
+            if( verbose ) { std::cerr << "cv-index: indexed " << index.size() << " frame(s) of \"" << filename << "\" in \"" << index_filename << "\"" << std::endl; }
+            return 0;
+        }
+        if( operation == "cat" )
+        {
+            snark::cv_mat::frame_index index;
+            std::ifstream test( index_filename.c_str() );
+            if( test.is_open() )
+            {
+                test.close();
+                index = snark::cv_mat::frame_index::load( index_filename );
+            }
+            else
+            {
+                std::ifstream ifs( filename.c_str(), std::ios::binary );
+                if( !ifs.is_open() ) { std::cerr << "cv-index: failed to open \"" << filename << "\"" << std::endl; return 1; }
+                index = snark::cv_mat::frame_index::make( ifs, input_options );
+                index.save( index_filename );
+                if( verbose ) { std::cerr << "cv-index: indexed " << index.size() << " frame(s) of \"" << filename << "\" in \"" << index_filename << "\"" << std::endl; }
+            }
+            snark::cv_mat::frame_reader reader( filename, index, input_options );
+            std::size_t from = options.value< std::size_t >( "--from", 0 );
+            std::size_t to = options.value< std::size_t >( "--to", index.size() );
+            if( options.exists( "--since" ) ) { from = std::max( from, index.lower_bound( boost::posix_time::from_iso_string( options.value< std::string >( "--since" ) ) ) ); }
+            if( options.exists( "--until" ) ) { to = std::min( to, index.lower_bound( boost::posix_time::from_iso_string( options.value< std::string >( "--until" ) ) ) ); }
+            if( to > index.size() ) { to = index.size(); }
+            snark::cv_mat::serialization output( input_options );
+            comma::signal_flag is_shutdown;
+            for( std::size_t i = from; i < to && !is_shutdown && std::cout.good(); ++i ) { output.write( std::cout, reader[i] ); }
+            return 0;
+        }
+        std::cerr << "cv-index: expected operation, got \"" << operation << "\"" << std::endl;
+    }
+    catch( std::exception& ex )
+    {
+        std::cerr << "cv-index: " << ex.what() << std::endl;
+    }
+    catch( ... )
+    {
+        std::cerr << "cv-index: unknown exception" << std::endl;
+    }
+    return 1;
+}
@@ -34,6 +34,7 @@
 #ifdef WIN32
 #include <winsock2.h>
 #endif
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 #include <limits>
@@ -47,6 +48,8 @@
 #include <boost/scoped_ptr.hpp>
 #include <boost/thread.hpp>
 #include <opencv2/highgui/highgui.hpp>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
 #include <comma/application/command_line_options.h>
 #include <comma/application/signal_flag.h>
 #include <comma/base/exception.h>
@@ -69,6 +72,8 @@ void usage()
     std::cerr << std::endl;
     std::cerr << "options" << std::endl;
     std::cerr << "    --binary,-b=<format>: binary input format" << std::endl;
+    std::cerr << "                          if values are all doubles or all floats, they are read directly" << std::endl;
+    std::cerr << "                          from the input record, without per-value deserialization" << std::endl;
     std::cerr << "    --clockwise: if polar, clockwise rotation; default: counter-clockwise" << std::endl;
     std::cerr << "    --colour-map,--colourmap,--colour=<which>: currently 'hot', 'jet', 'green', 'red', or <r>,<g>,<b>; default green (0,255,0)" << std::endl;
     std::cerr << "    --delimiter,-d: csv delimiter; default ','" << std::endl;
@@ -91,6 +96,7 @@ void usage()
     std::cerr << "        default: block,row,values" << std::endl;
     std::cerr << "    --fps=<value>: if present, update image <value> frames per second" << std::endl;
     std::cerr << "                   if absent, update on every new revolution (then revolution and sweep fields have to be present)" << std::endl;
+    std::cerr << "    --interpolate: polar only: blend neighbouring rows and columns bilinearly; default: nearest pixel" << std::endl;
     std::cerr << "    --id=<id>[,<options>]: if id field present, channel id to output, e.g: --id=1 --id=\"3;scale=1,5\" --id=4" << std::endl;
     std::cerr << "        options: scale=<min>,<max>: see --scale" << std::endl;
     std::cerr << "                 colourmap=<value>: see --colourmap" << std::endl;
@@ -174,6 +180,17 @@ class scaled // quick and dirty
             return to_.first + ( v - from_.first ) * factor_;
         } 
         
+        /// scale array of values; branchless, so that the compiler can vectorise it
+        template < typename S >
+        void operator()( const S* values, T* scaled, std::size_t size ) const
+        {
+            for( std::size_t i = 0; i < size; ++i )
+            {
+                double v = to_.first + ( values[i] - from_.first ) * factor_;
+                scaled[i] = T( std::min( std::max( v, to_.first ), to_.second ) );
+            }
+        }
+        
     private:
         std::pair< double, double > from_;
         std::pair< double, double > to_;
@@ -277,7 +294,6 @@ static bool has_angle;
 static input in;
 static std::pair< double, double > scale;
 static boost::optional< double > fps;
-static std::vector< std::pair< double, double > > sin_cos;
 static cv::Mat image;
 typedef std::map< unsigned int, unsigned int > Ids;
 static Ids ids;
@@ -288,20 +304,102 @@ static comma::signal_flag is_shutdown;
 static snark::cv_mat::serialization::options output_options;
 static unsigned int pixel_size;
 static unsigned int offset_from_center; // quick and dirty
+static bool interpolate;
+static const char* binary_values = NULL; // if not null, values of the current record in the input buffer
+static comma::csv::format::types_enum binary_values_type;
 
-static std::vector< std::pair< double, double > > precomputed_sin_cos_()
+/// inverse polar mapping: for each pixel of a polar panel, the waterfall pixel(s) it is taken from
+/// built once for the given geometry, so that rendering is a plain gather without holes
+class polar_map
 {
-    if( !polar ) { return std::vector< std::pair< double, double > >(); }
-    std::vector< std::pair< double, double > > v( block_size ); // todo: quick and dirty; apparently easy to optimize
-    double step = ( M_PI * 2 ) / block_size;
-    double angle = 0;
-    for( std::size_t i = 0; i < v.size(); ++i, angle += step )
-    {
-        v[i].first = std::sin( -angle );
-        v[i].second = std::cos( -angle );
-    }
-    return v;
-}
+    public:
+        polar_map( unsigned int size, unsigned int image_cols, bool interpolate )
+            : size_( size )
+            , interpolate_( interpolate )
+            , entries_( size * size )
+        {
+            double center = row_size + offset_from_center;
+            double angle_step = ( M_PI * 2 ) / block_size;
+            for( unsigned int y = 0; y < size; ++y )
+            {
+                for( unsigned int x = 0; x < size; ++x )
+                {
+                    double dx = double( x ) - center;
+                    double dy = double( y ) - center;
+                    double radius = std::sqrt( dx * dx + dy * dy ) - offset_from_center; // inverse of x = cos( -angle ) * r, y = sign * sin( -angle ) * r
+                    double angle = -std::atan2( sign * dy, dx );
+                    if( angle < 0 ) { angle += M_PI * 2; }
+                    double row = angle / angle_step;
+                    entry& e = entries_[ y * size + x ];
+                    if( interpolate )
+                    {
+                        if( radius < -0.5 || radius >= row_size - 0.5 ) { continue; }
+                        if( radius < 0 ) { radius = 0; }
+                        unsigned int column = radius;
+                        unsigned int row0 = row;
+                        e.column_weight = ( radius - column ) * 256;
+                        e.row_weight = ( row - row0 ) * 256;
+                        if( column + 1 >= row_size ) { e.column_weight = 0; }
+                        row0 %= block_size;
+                        e.first = row0 * image_cols + column;
+                        e.second = ( ( row0 + 1 ) % block_size ) * image_cols + column;
+                    }
+                    else
+                    {
+                        int column = int( radius + 0.5 );
+                        if( radius < -0.5 || column >= int( row_size ) ) { continue; }
+                        e.first = ( ( unsigned int )( row + 0.5 ) % block_size ) * image_cols + column;
+                    }
+                }
+            }
+        }
+
+        /// render all channels into polar image, rows in parallel
+        void render( cv::Mat& polar_image, const cv::Mat& image, unsigned int channels ) const
+        {
+            ::tbb::parallel_for( ::tbb::blocked_range< unsigned int >( 0, size_ ), boost::bind( &polar_map::render_, this, boost::ref( polar_image ), boost::cref( image ), channels, _1 ) );
+        }
+
+    private:
+        struct entry
+        {
+            int first; // source pixel index or -1, if outside
+            int second; // for interpolation: same column in the next row
+            comma::uint16 column_weight; // of the next column, out of 256
+            comma::uint16 row_weight; // of the next row, out of 256
+            entry() : first( -1 ), second( -1 ), column_weight( 0 ), row_weight( 0 ) {}
+        };
+        unsigned int size_;
+        bool interpolate_;
+        std::vector< entry > entries_;
+
+        void render_( cv::Mat& polar_image, const cv::Mat& image, unsigned int channels, const ::tbb::blocked_range< unsigned int >& r ) const
+        {
+            for( unsigned int y = r.begin(); y < r.end(); ++y )
+            {
+                for( unsigned int i = 0; i < channels; ++i )
+                {
+                    const unsigned char* source = image.datastart + row_size * i * pixel_size;
+                    unsigned char* target = polar_image.ptr( y ) + size_ * i * pixel_size;
+                    const entry* e = &entries_[ y * size_ ];
+                    for( unsigned int x = 0; x < size_; ++x, ++e, target += pixel_size )
+                    {
+                        if( e->first < 0 ) { ::memset( target, 0, pixel_size ); continue; }
+                        const unsigned char* p = source + e->first * pixel_size;
+                        if( !interpolate_ ) { ::memcpy( target, p, pixel_size ); continue; }
+                        const unsigned char* q = source + e->second * pixel_size;
+                        unsigned int next = e->column_weight ? pixel_size : 0;
+                        for( unsigned int k = 0; k < pixel_size; ++k )
+                        {
+                            unsigned int a = p[k] * ( 256 - e->column_weight ) + p[ k + next ] * e->column_weight;
+                            unsigned int b = q[k] * ( 256 - e->column_weight ) + q[ k + next ] * e->column_weight;
+                            target[k] = ( a * ( 256 - e->row_weight ) + b * e->row_weight + 32768 ) >> 16;
+                        }
+                    }
+                }
+            }
+        }
+};
 
 static void output_once_( const boost::posix_time::ptime& t )
 {
@@ -311,27 +409,8 @@ static void output_once_( const boost::posix_time::ptime& t )
         static unsigned int polar_size = ( row_size + offset_from_center ) * 2 + 1;
         static unsigned int type = output_options.get_header().type;
         static cv::Mat polar_image( polar_size, polar_size * ids.size(), type );
-        ::memset( polar_image.datastart, 0, polar_image.dataend - polar_image.datastart );
-        for( unsigned int i = 0; i < ids.size(); ++i )
-        {
-            unsigned int offset = row_size * i;
-            unsigned int polar_offset = polar_size * i;
-            for( unsigned int row = 0; row < block_size; ++row )
-            {
-                double x_step = sin_cos[row].second; 
-                double y_step = sin_cos[row].first * sign;
-                double x = row_size + offset_from_center + polar_offset; 
-                double y = row_size + offset_from_center;
-                x += sin_cos[row].second * offset_from_center;
-                y += sin_cos[row].first * sign * offset_from_center;
-                for( unsigned int column = 0; column < row_size; ++column, x += x_step, y += y_step )
-                {
-                    ::memcpy( polar_image.datastart + ( int( y ) * ( polar_image.cols ) + int( x ) ) * pixel_size
-                            , image.datastart + ( int( row ) * image.cols + offset + column ) * pixel_size
-                            , pixel_size );
-                }
-            }
-        }
+        static const polar_map map( polar_size, image.cols, interpolate );
+        map.render( polar_image, image, ids.size() );
         output.second = polar_image;
     }
     else
@@ -469,6 +548,8 @@ class channel
         unsigned int row_count_;
         double angle_step_;
         options options_;
+        std::vector< unsigned char > indices_;
+        std::vector< double > buffer_; // to align binary values, if needed
         
         void draw_dial_()
         {
@@ -493,23 +574,39 @@ class channel
         
         void draw_line_( const input* p, unsigned int row )
         {
-            unsigned int offset = ( image.cols * row + index_ * row_size ) * pixel_size;
-            if( pixel_size == 1 ) // quick and dirty
+            unsigned char* line = image.datastart + ( image.cols * row + index_ * row_size ) * pixel_size;
+            if( !binary_values ) { draw_line_( &p->values[0], line ); return; }
+            switch( binary_values_type )
             {
-                for( unsigned int i = 0; i < row_size; ++i )
-                {
-                    *( image.datastart + offset + i ) = scaled_( p->values[i] );
-                }
+                case comma::csv::format::double_t: draw_line_( aligned_< double >( binary_values ), line ); break;
+                case comma::csv::format::float_t: draw_line_( aligned_< float >( binary_values ), line ); break;
+                default: COMMA_THROW( comma::exception, "image-accumulate: expected double or float values" ); // never here
             }
-            else
+        }
+        
+        template < typename T >
+        void draw_line_( const T* values, unsigned char* line )
+        {
+            if( pixel_size == 1 ) { scaled_( values, line, row_size ); return; } // quick and dirty
+            indices_.resize( row_size );
+            scaled_( values, &indices_[0], row_size );
+            for( unsigned int i = 0; i < row_size; ++i, line += 3 )
             {
-                for( unsigned int i = 0; i < row_size; ++i )
-                {
-                    const boost::array< unsigned char, 3 >& colour = colourmap_[ scaled_( p->values[i] ) ];
-                    ::memcpy( image.datastart + offset + i * 3, &colour[0], 3 );   
-                }
+                const color_map::pixel& colour = colourmap_[ indices_[i] ];
+                line[0] = colour[0];
+                line[1] = colour[1];
+                line[2] = colour[2];
             }
         }
+        
+        template < typename T >
+        const T* aligned_( const char* values )
+        {
+            if( reinterpret_cast< std::size_t >( values ) % sizeof( T ) == 0 ) { return reinterpret_cast< const T* >( values ); }
+            buffer_.resize( row_size );
+            ::memcpy( &buffer_[0], values, row_size * sizeof( T ) );
+            return reinterpret_cast< const T* >( &buffer_[0] );
+        }
 };
 
 namespace comma { namespace visiting {
@@ -545,6 +642,7 @@ int main( int ac, char** av )
         as_radians = !options.exists( "--degrees" );
         clockwise = options.exists( "--clockwise" );
         offset_from_center = options.value( "--offset-from-center", 0 ); // quick and dirty
+        interpolate = options.exists( "--interpolate" );
         z_up = options.value< std::string >( "--z", "up" ) == "up";
         sign = ( z_up && !clockwise ) || ( !z_up && clockwise ) ? 1 : -1;
         if( options.exists( "--fps" ) ) { dial_size = options.value( "--dial-size,--dial", 0 ); }
@@ -556,7 +654,6 @@ int main( int ac, char** av )
         scale = comma::csv::ascii< std::pair< double, double > >().get( options.value< std::string >( "--scale", "0,255" ) );
         scaled< unsigned char > scaled( scale );
         fps = options.optional< double >( "--fps" );
-        sin_cos = precomputed_sin_cos_();
         channel::options default_channel_options( options );
         std::vector< channel::options > channel_options;
         if( csv.has_field( "id" ) )
@@ -579,7 +676,28 @@ int main( int ac, char** av )
         has_row = csv.has_field( "row" );
         has_angle = csv.has_field( "angle" );
         if( has_row && has_angle ) { std::cerr << "image-accumulate: in input fields, expected either 'row' or 'angle'; got both" << std::endl; return 1; }
-        comma::csv::input_stream< input > istream( std::cin, csv, in ); // todo: watch performance!
+        comma::csv::options input_csv = csv;
+        boost::optional< std::size_t > binary_values_offset;
+        if( csv.binary() ) // fast path: take values directly from the input record
+        {
+            std::vector< std::string > fields = comma::split( csv.fields, ',' );
+            std::vector< std::string >::iterator values_field = std::find( fields.begin(), fields.end(), "values" );
+            std::size_t index = values_field - fields.begin();
+            if( values_field != fields.end() && csv.format().count() >= index + row_size )
+            {
+                binary_values_type = csv.format().offset( index ).type;
+                bool uniform = binary_values_type == comma::csv::format::double_t || binary_values_type == comma::csv::format::float_t;
+                for( std::size_t i = 1; uniform && i < row_size; ++i ) { uniform = csv.format().offset( index + i ).type == binary_values_type; }
+                if( uniform )
+                {
+                    binary_values_offset = csv.format().offset( index ).offset;
+                    *values_field = "values[0]"; // to keep fields non-empty; the rest of values are not deserialized
+                    input_csv.fields = comma::join( fields, ',' );
+                    if( verbose ) { std::cerr << "image-accumulate: reading binary values directly from input records" << std::endl; }
+                }
+            }
+        }
+        comma::csv::input_stream< input > istream( std::cin, input_csv, in );
         std::string default_output_options = "no-header;rows=" + boost::lexical_cast< std::string >( polar ? row_size * 2 + 1 : block_size ) + ";cols=" + boost::lexical_cast< std::string >( polar ? ( row_size * 2 + 1 ) * ids.size() : row_size * ids.size() ) + ";type=3ub";
         std::string output_options_string = options.value( "--output", default_output_options );
         output_options = comma::name_value::parser( ';', '=' ).get< snark::cv_mat::serialization::options >( output_options_string );
@@ -595,6 +713,7 @@ int main( int ac, char** av )
             const input* p = istream.read();
             if( p )
             {
+                if( binary_values_offset ) { binary_values = istream.binary().last() + *binary_values_offset; }
                 Ids::const_iterator it = ids.find( p->id );
                 if( it == ids.end() ) { continue; }
                 if( !channels[ it->second ].draw( p ) ) { break; }
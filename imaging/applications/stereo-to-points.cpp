@@ -104,6 +104,7 @@ int main( int argc, char** argv )
         std::string leftImage;
         std::string rightImage;
         std::string roi;
+        std::string cacheDirectory;
         
         description.add_options()
             ( "help,h", "display help message" )
@@ -117,6 +118,7 @@ int main( int argc, char** argv )
             ( "disparity", "output disparity image instead of point cloud" )
             ( "output-rectified", "output rectified image pair instead of point cloud" )
             ( "input-rectified", "input images are already rectified" )
+            ( "cache", boost::program_options::value< std::string >( &cacheDirectory ), "cache rectification maps in given directory, keyed by calibration; saves startup time when run once per image pair" )
             ( "window-size,w", boost::program_options::value< int >( &sgbm.SADWindowSize )->default_value(5), "sgbm SADWindowSize (see OpenCV documentation)" )
             ( "min-disparity,m", boost::program_options::value< int >( &sgbm.minDisparity )->default_value(0), "sgbm minDisparity" )
             ( "num-disparity,n", boost::program_options::value< int >( &sgbm.numberOfDisparities )->default_value(80), "sgbm numberOfDisparities" )
@@ -195,6 +197,9 @@ int main( int argc, char** argv )
             std::cerr << "    point cloud: " << std::endl;
             std::cerr << "    find left -name '*.ppm' | sort | parallel  'stereo-to-points --left left/{/} --right right/{/} --config bumblebee.config \\" << std::endl;;
             std::cerr << "    --left-path left --right-path right --binary t,3d,3ub,ui --full-dp > cloud-{/.}.bin" << std::endl;
+            std::cerr << "    same, but computing rectification maps only once: " << std::endl;
+            std::cerr << "    find left -name '*.ppm' | sort | parallel  'stereo-to-points --left left/{/} --right right/{/} --config bumblebee.config \\" << std::endl;
+            std::cerr << "    --left-path left --right-path right --binary t,3d,3ub,ui --full-dp --cache /tmp > cloud-{/.}.bin" << std::endl;
             std::cerr << std::endl;
             std::cerr << "  known bugs: point cloud doesn't seem to work with opencv 2.3 ( e.g. on shrimp ), works with opencv 2.4 " << std::endl;
             std::cerr << std::endl;
@@ -202,6 +207,7 @@ int main( int argc, char** argv )
         }
 
         sgbm.fullDP = ( vm.count( "full-dp" ) );
+        snark::imaging::rectify_map::cache( cacheDirectory );
         
         snark::imaging::camera_parser leftParameters( configFile, leftPath );
         snark::imaging::camera_parser rightParameters( configFile, rightPath );
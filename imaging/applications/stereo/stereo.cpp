@@ -79,46 +79,35 @@ void stereo::process( const cv::Mat& left, const cv::Mat& right, const cv::Stere
 {
     snark::imaging::point_cloud cloud( sgbm );
 
-    cv::Mat points;
-    cv::Mat leftRectified;
     if (!m_input_rectified)
     {
-        leftRectified = m_rectify.remap_left( left );
+        cv::Mat leftRectified = m_rectify.remap_left( left );
         cv::Mat rightRectified = m_rectify.remap_right( right );
-        points = cloud.get( m_rectify.Q(), leftRectified, rightRectified );
+        cloud.get( m_rectify.Q(), leftRectified, rightRectified, m_points ); // TODO config max distance ?
     }
     else
     {
-        leftRectified = left;
-        points = cloud.get( m_rectify.Q(), left, right );
+        cloud.get( m_rectify.Q(), left, right, m_points );
     }
-    for( int i = 0; i < points.rows; i++ )
+    for( std::size_t i = 0; i < m_points.size(); ++i )
     {
-       for( int j = 0; j < points.cols; j++ )
-       {
-            cv::Point3f point = points.at< cv::Point3f >( i, j );
-            if( std::fabs( point.z ) < 10000 ) // CV uses 10,000 as invalid. TODO config max distance ?
-            {
-                point *= 16.0; // disparity has a factor 16
-                cv::Vec3b color = leftRectified.at< cv::Vec3b >( i, j );
-                colored_point point_color( point.x, point.y, point.z, color[2], color[1], color[0] );
-                point_color.time = time;
-                point_color.block = m_frame_counter;
-                if( m_binary )
-                {
-                    m_binary->put( point_color, &m_output[0] );
-                    std::cout.write( &m_output[0], m_output.size() );
-                    std::cout.flush();
-                }
-                else
-                {
-                    std::string line;
-                    m_ascii->put( point_color, line );
-                    std::cout << line << std::endl;
-                }
-            }
-       }
+        const cv::Vec3b& color = m_points.colours[i];
+        colored_point point_color( m_points.x[i], m_points.y[i], m_points.z[i], color[2], color[1], color[0] );
+        point_color.time = time;
+        point_color.block = m_frame_counter;
+        if( m_binary )
+        {
+            m_binary->put( point_color, &m_output[0] );
+            std::cout.write( &m_output[0], m_output.size() );
+        }
+        else
+        {
+            std::string line;
+            m_ascii->put( point_color, line );
+            std::cout << line << '\n';
+        }
     }
+    std::cout.flush();
     m_frame_counter++;
 }
 
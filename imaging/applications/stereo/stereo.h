@@ -75,6 +75,7 @@ private:
     boost::scoped_ptr< comma::csv::binary< colored_point > > m_binary;
     std::vector< char > m_output;
     unsigned int m_frame_counter;
+    point_cloud::sparse m_points;
 };
 
 } }
@@ -31,6 +31,7 @@
 // IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 
+#include <algorithm>
 #include <fstream>
 #include <sstream>
 #include <boost/bind.hpp>
@@ -45,10 +46,42 @@
 #include <opencv2/imgproc/imgproc_c.h>
 #include <opencv2/highgui/highgui.hpp>
 #include <opencv2/highgui/highgui_c.h>
+#include <tbb/parallel_for.h>
+#include <tbb/task_scheduler_init.h>
 
 namespace snark{ namespace cv_mat {
 
-static filters::value_type cvt_color_impl_( filters::value_type m, unsigned int which )
+typedef boost::function< void( unsigned int, unsigned int ) > band_function;
+
+static void band_impl_( unsigned int i, unsigned int step, unsigned int rows, const band_function& f )
+{
+    unsigned int begin = i * step;
+    if( begin < rows ) { f( begin, std::min( begin + step, rows ) ); }
+}
+
+/// call f( begin, end ) for horizontal bands of rows in parallel
+/// @param bands number of bands, 0: one band per core
+/// @param align band boundaries are multiples of align rows
+static void for_each_band_( unsigned int rows, unsigned int bands, unsigned int align, const band_function& f )
+{
+    unsigned int n = bands == 0 ? ::tbb::task_scheduler_init::default_num_threads() : bands;
+    if( n <= 1 || rows < 2 * align ) { f( 0, rows ); return; }
+    unsigned int step = ( ( rows + n - 1 ) / n + align - 1 ) / align * align;
+    ::tbb::parallel_for( 0u, n, boost::bind( &band_impl_, _1, step, rows, boost::cref( f ) ) );
+}
+
+static void cvt_color_band_( const cv::Mat& in, cv::Mat& out, int code, unsigned int begin, unsigned int end )
+{
+    static const unsigned int halo = 2; // enough for bilinear demosaicing, keeps bayer pattern phase
+    unsigned int first = begin < halo ? 0 : begin - halo;
+    unsigned int last = std::min( end + halo, static_cast< unsigned int >( in.rows ) );
+    cv::Mat converted;
+    cv::cvtColor( in.rowRange( first, last ), converted, code );
+    cv::Mat band = out.rowRange( begin, end );
+    converted.rowRange( begin - first, end - first ).copyTo( band );
+}
+
+static filters::value_type cvt_color_impl_( filters::value_type m, unsigned int which, unsigned int bands )
 {
     filters::value_type n;
     n.first = m.first;
@@ -58,7 +91,10 @@ static filters::value_type cvt_color_impl_( filters::value_type m, unsigned int
         cv::cvtColor( m.second, grey, CV_RGB2GRAY );
         m.second = grey;
     }
-    cv::cvtColor( m.second, n.second, which + 45u ); // HACK, bayer as unsigned int, but I don't find enum { BG2RGB, GB2BGR ... } more usefull
+    int code = which + 45u; // HACK, bayer as unsigned int, but I don't find enum { BG2RGB, GB2BGR ... } more usefull
+    if( bands == 1 ) { cv::cvtColor( m.second, n.second, code ); return n; }
+    n.second.create( m.second.rows, m.second.cols, CV_MAKETYPE( m.second.depth(), 3 ) );
+    for_each_band_( m.second.rows, bands, 2, boost::bind( &cvt_color_band_, boost::cref( m.second ), boost::ref( n.second ), code, _1, _2 ) );
     return n;
 }
 
@@ -179,18 +215,20 @@ static filters::value_type text_impl_( filters::value_type m, const std::string&
 class undistort_impl_
 {
     public:
-        undistort_impl_( const std::string filename ) : filename_( filename ) {}
+        undistort_impl_( const std::string filename, unsigned int bands = 1 ) : filename_( filename ), bands_( bands ) {}
 
         filters::value_type operator()( filters::value_type m )
         {
             init_map_( m.second.rows, m.second.cols );
             filters::value_type n( m.first, cv::Mat( m.second.size(), m.second.type(), cv::Scalar::all(0) ) );
-            cv::remap( m.second, n.second, x_, y_, cv::INTER_LINEAR, cv::BORDER_TRANSPARENT );
+            if( bands_ == 1 ) { cv::remap( m.second, n.second, x_, y_, cv::INTER_LINEAR, cv::BORDER_TRANSPARENT ); }
+            else { for_each_band_( m.second.rows, bands_, 1, boost::bind( &undistort_impl_::remap_band_, this, boost::cref( m.second ), boost::ref( n.second ), _1, _2 ) ); }
             return n;
         }
 
     private:
         std::string filename_;
+        unsigned int bands_;
         std::vector< char > xbuf_;
         std::vector< char > ybuf_;
         cv::Mat x_;
@@ -212,6 +250,11 @@ class undistort_impl_
             x_ = cv::Mat( rows, cols, CV_32FC1, &xbuf_[0] );
             y_ = cv::Mat( rows, cols, CV_32FC1, &ybuf_[0] );
         }
+        void remap_band_( const cv::Mat& in, cv::Mat& out, unsigned int begin, unsigned int end ) const // output rows map to any input rows, so no halo needed
+        {
+            cv::Mat band = out.rowRange( begin, end );
+            cv::remap( in, band, x_.rowRange( begin, end ), y_.rowRange( begin, end ), cv::INTER_LINEAR, cv::BORDER_TRANSPARENT );
+        }
 };
 
 std::vector< filter > filters::make( const std::string& how )
@@ -222,6 +265,7 @@ std::vector< filter > filters::make( const std::string& how )
     std::string name;
     bool modified = false;
     bool last = false;
+    unsigned int bands = 1;
     for( std::size_t i = 0; i < v.size(); name += ( i > 0 ? ";" : "" ) + v[i], ++i )
     {
         if( last )
@@ -229,11 +273,17 @@ std::vector< filter > filters::make( const std::string& how )
             COMMA_THROW( comma::exception, "cannot have a filter after encode" );
         }
         std::vector< std::string > e = comma::split( v[i], '=' );
+        if( e[0] == "bands" )
+        {
+            if( e.size() < 2 ) { COMMA_THROW( comma::exception, "expected bands=<number>, got \"" << v[i] << "\"" ); }
+            bands = boost::lexical_cast< unsigned int >( e[1] );
+            continue;
+        }
         if( e[0] == "bayer" )
         {
             if( modified ) { COMMA_THROW( comma::exception, "cannot covert from bayer after transforms: " << name ); }
             unsigned int which = boost::lexical_cast< unsigned int >( e[1] );
-            f.push_back( filter( boost::bind( &cvt_color_impl_, _1, which ) ) );
+            f.push_back( filter( boost::bind( &cvt_color_impl_, _1, which, bands ) ) );
         }
         else if( e[0] == "crop" )
         {
@@ -347,7 +397,7 @@ std::vector< filter > filters::make( const std::string& how )
         }
         else if( e[0] == "undistort" )
         {
-            f.push_back( filter( undistort_impl_( e[1] ) ) );
+            f.push_back( filter( undistort_impl_( e[1], bands ) ) );
         }
         else if( e[0] == "view" )
         {
@@ -376,6 +426,7 @@ std::vector< filter > filters::make( const std::string& how )
         {
             COMMA_THROW( comma::exception, "expected filter, got \"" << v[i] << "\"" );
         }
+        f.back().name = e[0];
         modified = ( v[i] != "view" && v[i] != "split" );
     }
     return f;
@@ -391,6 +442,8 @@ static std::string usage_impl_()
 {
     std::ostringstream oss;
     oss << "    cv::Mat image filters usage (';'-separated):" << std::endl;
+    oss << "        bands=<n>: process each image in <n> horizontal bands in parallel in the following bayer and undistort filters;" << std::endl;
+    oss << "                   0: one band per core; default: 1 (no bands); useful for low latency on large images" << std::endl;
     oss << "        bayer=<mode>: convert from bayer, <mode>=1-4" << std::endl;
     oss << "        crop=[<x>,<y>],<width>,<height>: crop the portion of the image starting at x,y with size width x height" << std::endl;
     oss << "        crop-tile=[<x>,<y>],<num-tile-x>,<num-tile-y>: divide the image in num-tile-x x num-tile-y tiles, and crop the tile x,y (count from zero)" << std::endl;
@@ -34,6 +34,7 @@
 #ifndef SNARK_IMAGING_CVMAT_FILTERS_H_
 #define SNARK_IMAGING_CVMAT_FILTERS_H_
 
+#include <string>
 #include <vector>
 #include <boost/function.hpp>
 #include <boost/date_time/posix_time/posix_time.hpp>
@@ -48,6 +49,7 @@ struct filter
     filter( boost::function< value_type( value_type ) > f, bool p = true ): filter_function( f ), parallel( p ) {}
     boost::function< value_type( value_type ) > filter_function;
     bool parallel;
+    std::string name;
 };
 
 /// filter pipeline helpers
@@ -0,0 +1,144 @@
+// This file is part of snark, a generic and flexible library for robotics research
+// Copyright (c) 2011 The University of Sydney
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. All advertising materials mentioning features or use of this software
+//    must display the following acknowledgement:
+//    This product includes software developed by the The University of Sydney.
+// 4. Neither the name of the The University of Sydney nor the
+//    names of its contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+//
+// NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+// GRANTED BY THIS LICENSE.  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+// HOLDERS AND CONTRIBUTORS \"AS IS\" AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+// BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+// OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+// IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <algorithm>
+#include <fstream>
+#include <comma/base/exception.h>
+#include <comma/csv/binary.h>
+#include "./frame_index.h"
+
+namespace snark{ namespace cv_mat {
+
+static bool timestamp_less_( const frame_index::entry& e, const boost::posix_time::ptime& t ) { return e.timestamp < t; }
+
+frame_index frame_index::make( std::istream& is, const serialization::options& options )
+{
+    serialization s( options );
+    std::vector< char > buffer( s.header_size() );
+    frame_index index;
+    comma::uint64 offset = 0;
+    while( is.good() && !is.eof() )
+    {
+        if( !buffer.empty() )
+        {
+            is.read( &buffer[0], buffer.size() );
+            if( is.gcount() <= 0 ) { break; }
+            if( std::size_t( is.gcount() ) < buffer.size() ) { COMMA_THROW( comma::exception, "expected " << buffer.size() << " bytes of header at offset " << offset << ", got " << is.gcount() ); }
+        }
+        serialization::header h = s.get_header( buffer.empty() ? NULL : &buffer[0] );
+        std::size_t size = std::size_t( h.rows ) * h.cols * CV_ELEM_SIZE( h.type );
+        if( size == 0 ) { COMMA_THROW( comma::exception, "got empty image at offset " << offset ); }
+        is.ignore( size );
+        std::size_t count = is.gcount();
+        if( count == 0 && buffer.empty() ) { break; } // no header: end of stream
+        if( count < size ) { COMMA_THROW( comma::exception, "expected " << size << " bytes of image data at offset " << offset << ", got " << count ); }
+        entry e;
+        e.offset = offset;
+        e.timestamp = h.timestamp;
+        e.rows = h.rows;
+        e.cols = h.cols;
+        e.type = h.type;
+        index.push_back( e );
+        offset += buffer.size() + size;
+    }
+    return index;
+}
+
+frame_index frame_index::load( const std::string& filename )
+{
+    std::ifstream ifs( filename.c_str(), std::ios::binary );
+    if( !ifs.is_open() ) { COMMA_THROW( comma::exception, "failed to open \"" << filename << "\"" ); }
+    comma::csv::binary< entry > binary;
+    std::vector< char > buffer( binary.format().size() );
+    frame_index index;
+    while( ifs.good() && !ifs.eof() )
+    {
+        ifs.read( &buffer[0], buffer.size() );
+        if( ifs.gcount() <= 0 ) { break; }
+        if( std::size_t( ifs.gcount() ) < buffer.size() ) { COMMA_THROW( comma::exception, "\"" << filename << "\": expected " << buffer.size() << " bytes, got " << ifs.gcount() ); }
+        entry e;
+        binary.get( e, &buffer[0] );
+        index.push_back( e );
+    }
+    return index;
+}
+
+void frame_index::save( const std::string& filename ) const
+{
+    std::ofstream ofs( filename.c_str(), std::ios::binary );
+    if( !ofs.is_open() ) { COMMA_THROW( comma::exception, "failed to open \"" << filename << "\"" ); }
+    comma::csv::binary< entry > binary;
+    std::vector< char > buffer( binary.format().size() );
+    for( std::size_t i = 0; i < entries_.size(); ++i )
+    {
+        binary.put( entries_[i], &buffer[0] );
+        ofs.write( &buffer[0], buffer.size() );
+    }
+    if( !ofs.good() ) { COMMA_THROW( comma::exception, "failed to write \"" << filename << "\"" ); }
+}
+
+std::string frame_index::filename( const std::string& recorded ) { return recorded + ".index"; }
+
+std::size_t frame_index::lower_bound( const boost::posix_time::ptime& t ) const
+{
+    return std::lower_bound( entries_.begin(), entries_.end(), t, timestamp_less_ ) - entries_.begin();
+}
+
+frame_reader::frame_reader( const std::string& filename, const frame_index& index, const serialization::options& options )
+    : index_( index )
+    , file_( filename.c_str(), boost::interprocess::read_only )
+    , region_( file_, boost::interprocess::read_only )
+    , header_size_( serialization( options ).header_size() )
+{
+    if( index_.size() == 0 ) { return; }
+    const frame_index::entry& last = index_[ index_.size() - 1 ];
+    if( last.offset + header_size_ + std::size_t( last.rows ) * last.cols * CV_ELEM_SIZE( last.type ) > region_.get_size() )
+    {
+        COMMA_THROW( comma::exception, "index does not match \"" << filename << "\": last frame ends beyond end of file" );
+    }
+}
+
+std::pair< boost::posix_time::ptime, cv::Mat > frame_reader::operator[]( std::size_t i ) const
+{
+    const frame_index::entry& e = index_[i];
+    char* data = static_cast< char* >( region_.get_address() ) + e.offset + header_size_;
+    return std::make_pair( e.timestamp, cv::Mat( e.rows, e.cols, e.type, data ) );
+}
+
+std::pair< boost::posix_time::ptime, cv::Mat > frame_reader::at( const boost::posix_time::ptime& t ) const
+{
+    std::size_t i = index_.lower_bound( t );
+    return i < index_.size() ? operator[]( i ) : std::pair< boost::posix_time::ptime, cv::Mat >();
+}
+
+} } // namespace snark{ namespace cv_mat {
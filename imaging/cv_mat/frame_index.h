@@ -0,0 +1,152 @@
+// This file is part of snark, a generic and flexible library for robotics research
+// Copyright (c) 2011 The University of Sydney
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. All advertising materials mentioning features or use of this software
+//    must display the following acknowledgement:
+//    This product includes software developed by the The University of Sydney.
+// 4. Neither the name of the The University of Sydney nor the
+//    names of its contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+//
+// NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+// GRANTED BY THIS LICENSE.  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+// HOLDERS AND CONTRIBUTORS \"AS IS\" AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+// BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+// OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+// IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef SNARK_IMAGING_CVMAT_FRAME_INDEX_H_
+#define SNARK_IMAGING_CVMAT_FRAME_INDEX_H_
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <opencv2/core/core.hpp>
+#include <comma/base/types.h>
+#include <comma/visiting/traits.h>
+#include <snark/imaging/cv_mat/serialization.h>
+
+namespace snark{ namespace cv_mat {
+
+/// index of frames in a recorded stream of serialized images (e.g. cv-cat or gige-cat output)
+class frame_index
+{
+    public:
+        /// index entry
+        struct entry
+        {
+            comma::uint64 offset; /// offset of frame header in the recorded file
+            boost::posix_time::ptime timestamp;
+            comma::uint32 rows;
+            comma::uint32 cols;
+            comma::uint32 type;
+
+            entry() : offset( 0 ), rows( 0 ), cols( 0 ), type( 0 ) {}
+        };
+
+        /// build index in a single pass over the stream, skipping image data
+        static frame_index make( std::istream& is, const serialization::options& options );
+
+        /// load index from file
+        static frame_index load( const std::string& filename );
+
+        /// save index to file as binary records of entry (see comma::csv::format::value< frame_index::entry >())
+        void save( const std::string& filename ) const;
+
+        /// default sidecar index filename for a recorded file
+        static std::string filename( const std::string& recorded );
+
+        /// number of frames
+        std::size_t size() const { return entries_.size(); }
+
+        /// return entry
+        const entry& operator[]( std::size_t i ) const { return entries_[i]; }
+
+        /// add entry
+        void push_back( const entry& e ) { entries_.push_back( e ); }
+
+        /// return index of the first frame with timestamp not less than t, or size(), if none
+        /// @note assumes timestamps non-decreasing
+        std::size_t lower_bound( const boost::posix_time::ptime& t ) const;
+
+    private:
+        std::vector< entry > entries_;
+};
+
+/// random access to frames of a recorded file by index or time, file memory-mapped
+class frame_reader
+{
+    public:
+        /// constructor
+        frame_reader( const std::string& filename, const frame_index& index, const serialization::options& options );
+
+        /// return index
+        const frame_index& index() const { return index_; }
+
+        /// return number of frames
+        std::size_t size() const { return index_.size(); }
+
+        /// return i-th frame
+        /// @note image data is not copied and refers to the read-only mapped file:
+        ///       do not modify it; clone it, if it needs to outlive the reader
+        std::pair< boost::posix_time::ptime, cv::Mat > operator[]( std::size_t i ) const;
+
+        /// return first frame with timestamp not less than t, empty, if none
+        std::pair< boost::posix_time::ptime, cv::Mat > at( const boost::posix_time::ptime& t ) const;
+
+    private:
+        frame_index index_;
+        boost::interprocess::file_mapping file_;
+        boost::interprocess::mapped_region region_;
+        std::size_t header_size_;
+};
+
+} }  // namespace snark{ namespace cv_mat {
+
+namespace comma { namespace visiting {
+
+template <> struct traits< snark::cv_mat::frame_index::entry >
+{
+    template < typename K, typename V >
+    static void visit( const K&, snark::cv_mat::frame_index::entry& e, V& v )
+    {
+        v.apply( "offset", e.offset );
+        v.apply( "t", e.timestamp );
+        v.apply( "rows", e.rows );
+        v.apply( "cols", e.cols );
+        v.apply( "type", e.type );
+    }
+
+    template < typename K, typename V >
+    static void visit( const K&, const snark::cv_mat::frame_index::entry& e, V& v )
+    {
+        v.apply( "offset", e.offset );
+        v.apply( "t", e.timestamp );
+        v.apply( "rows", e.rows );
+        v.apply( "cols", e.cols );
+        v.apply( "type", e.type );
+    }
+};
+
+} } // namespace comma { namespace visiting {
+
+#endif // SNARK_IMAGING_CVMAT_FRAME_INDEX_H_
@@ -31,6 +31,9 @@
 // IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 
+#ifndef WIN32
+#include <unistd.h>
+#endif
 #include <snark/imaging/cv_mat/pipeline.h>
 #include <tbb/tbb_thread.h>
 #include <boost/bind.hpp>
@@ -43,13 +46,34 @@ namespace snark{ namespace imaging { namespace applications {
 /// @param filters string describing the filters
 /// @param size max buffer size
 /// @param mode output mode
-pipeline::pipeline( cv_mat::serialization& output, const std::string& filters, tbb::bursty_reader< pair >& reader ):
+/// @param statistics if not null, collect per-filter timing statistics
+pipeline::pipeline( cv_mat::serialization& output, const std::string& filters, tbb::bursty_reader< pair >& reader, pipeline_statistics* statistics ):
     m_output( output ),
-    m_reader( reader )
+    m_reader( reader ),
+    m_statistics( statistics )
 {
     setup_pipeline_( filters );
 }
 
+/// apply filter i, timing it
+pipeline::pair pipeline::timed_( std::size_t i, pair p )
+{
+    boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+    pair q = m_filters[i].filter_function( p );
+    m_statistics->add( m_stages[i], boost::posix_time::microsec_clock::universal_time() - start );
+    return q;
+}
+
+/// record latency and reader state, output statistics if due
+void pipeline::update_statistics_( const pair& p )
+{
+    if( !m_statistics ) { return; }
+    boost::posix_time::ptime now = boost::posix_time::microsec_clock::universal_time();
+    if( !p.first.is_not_a_date_time() ) { m_statistics->add_latency( now - p.first ); }
+    m_statistics->set_reader( m_reader.size(), m_reader.discarded() );
+    m_statistics->write_if_due( now );
+}
+
 /// write frame to std out
 void pipeline::write_( pair p )
 {
@@ -58,15 +82,21 @@ void pipeline::write_( pair p )
         m_reader.stop();
         return;
     }
+    update_statistics_( p );
     if( std::cout.bad() || !std::cout.good() || is_shutdown_ )
     {
         m_reader.stop();
     }
+    #ifdef WIN32
     m_output.write( std::cout, p );
+    #else
+    if( !m_output.write( STDOUT_FILENO, p ) ) { m_reader.stop(); } // nothing else writes to stdout, thus safe to bypass std::cout
+    #endif
 }
 
 void pipeline::null_( pair p )
 {
+    if( p.second.size().width > 0 ) { update_statistics_( p ); }
     if( p.second.size().width == 0 || std::cout.bad() || !std::cout.good() || is_shutdown_ )
     {
         m_reader.stop();
@@ -94,7 +124,16 @@ void pipeline::setup_pipeline_( const std::string& filters )
                 mode = ::tbb::filter::parallel;
             }
             if( !m_filters[i].filter_function ) { has_null = true; break; }
-            ::tbb::filter_t< pair, pair > filter( mode, boost::bind( m_filters[i].filter_function, _1 ) );
+            ::tbb::filter_t< pair, pair > filter;
+            if( m_statistics )
+            {
+                m_stages.push_back( m_statistics->add_stage( m_filters[i].name ) );
+                filter = ::tbb::filter_t< pair, pair >( mode, boost::bind( &pipeline::timed_, this, i, _1 ) );
+            }
+            else
+            {
+                filter = ::tbb::filter_t< pair, pair >( mode, boost::bind( m_filters[i].filter_function, _1 ) );
+            }
             all_filters = i == 0 ? filter : ( all_filters & filter );
         }
         m_filter = all_filters & ::tbb::filter_t< pair, void >( ::tbb::filter::serial_in_order, boost::bind( has_null ? &pipeline::null_ : &pipeline::write_, this, _1 ) );
@@ -105,6 +144,7 @@ void pipeline::setup_pipeline_( const std::string& filters )
 void pipeline::run()
 {
     m_pipeline.run( m_reader, m_filter );
+    if( m_statistics ) { m_statistics->write(); }
 }
 
 } } }
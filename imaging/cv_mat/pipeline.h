@@ -43,6 +43,7 @@
 #include <snark/imaging/cv_mat/bursty_pipeline.h>
 #include <snark/imaging/cv_mat/serialization.h>
 #include <snark/imaging/cv_mat/filters.h>
+#include <snark/imaging/cv_mat/pipeline_statistics.h>
 
 namespace snark {
     
@@ -63,7 +64,7 @@ class pipeline
 {
 public:
     typedef std::pair< boost::posix_time::ptime, cv::Mat > pair;
-    pipeline( cv_mat::serialization& output, const std::string& filters, tbb::bursty_reader< pair >& reader );
+    pipeline( cv_mat::serialization& output, const std::string& filters, tbb::bursty_reader< pair >& reader, pipeline_statistics* statistics = NULL );
 
     void run();
     
@@ -71,12 +72,16 @@ protected:
     void write_( pair p );
     void null_( pair p );
     void setup_pipeline_( const std::string& filters );
+    pair timed_( std::size_t i, pair p );
+    void update_statistics_( const pair& p );
 
     cv_mat::serialization& m_output;
     ::tbb::filter_t< pair, void > m_filter;
     std::vector< cv_mat::filter > m_filters;
     tbb::bursty_reader< pair >& m_reader;
     tbb::bursty_pipeline< pair > m_pipeline;
+    pipeline_statistics* m_statistics;
+    std::vector< unsigned int > m_stages;
     comma::signal_flag is_shutdown_;
 };
 
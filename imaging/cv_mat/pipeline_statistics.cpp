@@ -0,0 +1,147 @@
+// This file is part of snark, a generic and flexible library for robotics research
+// Copyright (c) 2011 The University of Sydney
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. All advertising materials mentioning features or use of this software
+//    must display the following acknowledgement:
+//    This product includes software developed by the The University of Sydney.
+// 4. Neither the name of the The University of Sydney nor the
+//    names of its contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+//
+// NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+// GRANTED BY THIS LICENSE.  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+// HOLDERS AND CONTRIBUTORS \"AS IS\" AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+// BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+// OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+// IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <sstream>
+#include <comma/base/exception.h>
+#include "./pipeline_statistics.h"
+
+namespace snark { namespace imaging { namespace applications {
+
+pipeline_statistics::stage::stage( const std::string& name ) : name( name ) { reset(); }
+
+void pipeline_statistics::stage::reset()
+{
+    count = 0;
+    total = 0;
+    min = 0;
+    max = 0;
+    histogram.assign( 0 );
+}
+
+void pipeline_statistics::stage::add( comma::int64 microseconds )
+{
+    comma::uint64 d = microseconds < 0 ? 0 : microseconds;
+    if( count == 0 || d < min ) { min = d; }
+    if( d > max ) { max = d; }
+    ++count;
+    total += d;
+    unsigned int k = 0;
+    for( ; d > 0 && k + 1 < histogram.size(); d >>= 1, ++k );
+    ++histogram[k];
+}
+
+pipeline_statistics::pipeline_statistics( const boost::posix_time::time_duration& period, const std::string& filename )
+    : period_( period )
+    , os_( &std::cerr )
+    , latency_( "latency" )
+    , queue_size_( 0 )
+    , discarded_( 0 )
+    , last_discarded_( 0 )
+{
+    if( !filename.empty() )
+    {
+        ofstream_.reset( new std::ofstream( filename.c_str() ) );
+        if( !ofstream_->is_open() ) { COMMA_THROW( comma::exception, "failed to open \"" << filename << "\"" ); }
+        os_ = ofstream_.get();
+    }
+}
+
+unsigned int pipeline_statistics::add_stage( const std::string& name )
+{
+    boost::mutex::scoped_lock lock( mutex_ );
+    stages_.push_back( stage( name ) );
+    return stages_.size() - 1;
+}
+
+void pipeline_statistics::add( unsigned int stage, const boost::posix_time::time_duration& elapsed )
+{
+    boost::mutex::scoped_lock lock( mutex_ );
+    stages_[stage].add( elapsed.total_microseconds() );
+}
+
+void pipeline_statistics::add_latency( const boost::posix_time::time_duration& latency )
+{
+    boost::mutex::scoped_lock lock( mutex_ );
+    latency_.add( latency.total_microseconds() );
+}
+
+void pipeline_statistics::set_reader( unsigned int queue_size, comma::uint64 discarded )
+{
+    boost::mutex::scoped_lock lock( mutex_ );
+    queue_size_ = queue_size;
+    discarded_ = discarded;
+}
+
+void pipeline_statistics::write_if_due( const boost::posix_time::ptime& now )
+{
+    if( last_.is_not_a_date_time() ) { last_ = now; return; }
+    if( now < last_ + period_ ) { return; }
+    write( now );
+}
+
+void pipeline_statistics::write( const boost::posix_time::ptime& now )
+{
+    boost::mutex::scoped_lock lock( mutex_ );
+    stage read( "read" );
+    read.count = latency_.count;
+    write_stage_( now, read, queue_size_, discarded_ - last_discarded_ );
+    for( std::size_t i = 0; i < stages_.size(); ++i ) { write_stage_( now, stages_[i], 0, 0 ); stages_[i].reset(); }
+    write_stage_( now, latency_, 0, 0 );
+    latency_.reset();
+    last_discarded_ = discarded_;
+    last_ = now;
+    os_->flush();
+}
+
+void pipeline_statistics::write_stage_( const boost::posix_time::ptime& t, const stage& s, unsigned int queue, comma::uint64 discarded )
+{
+    *os_ << boost::posix_time::to_iso_string( t ) << ',' << s.name << ',' << s.count << ',' << s.min << ',' << ( s.count == 0 ? 0 : s.total / s.count ) << ',' << s.max << ',' << queue << ',' << discarded;
+    for( std::size_t k = 0; k < s.histogram.size(); ++k ) { *os_ << ',' << s.histogram[k]; }
+    *os_ << std::endl;
+}
+
+std::string pipeline_statistics::usage()
+{
+    std::ostringstream oss;
+    oss << "    pipeline statistics: one csv line per stage per dump" << std::endl;
+    oss << "        fields: t,name,count,min,mean,max,queue,discarded,histogram[" << histogram_size << "]" << std::endl;
+    oss << "        name: filter name, or 'read' for input queue, or 'latency' for time from frame timestamp to output" << std::endl;
+    oss << "        min,mean,max: microseconds" << std::endl;
+    oss << "        queue: input queue size at dump time ('read' only)" << std::endl;
+    oss << "        discarded: number of frames discarded since last dump ('read' only)" << std::endl;
+    oss << "        histogram[k]: number of frames that took [2^(k-1),2^k) microseconds; histogram[0]: under 1 microsecond" << std::endl;
+    oss << "        counts are since the last dump" << std::endl;
+    return oss.str();
+}
+
+} } }
@@ -0,0 +1,112 @@
+// This file is part of snark, a generic and flexible library for robotics research
+// Copyright (c) 2011 The University of Sydney
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. All advertising materials mentioning features or use of this software
+//    must display the following acknowledgement:
+//    This product includes software developed by the The University of Sydney.
+// 4. Neither the name of the The University of Sydney nor the
+//    names of its contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+//
+// NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+// GRANTED BY THIS LICENSE.  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+// HOLDERS AND CONTRIBUTORS \"AS IS\" AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+// BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+// OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+// IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef SNARK_IMAGING_APPLICATIONS_PIPELINE_STATISTICS_H_
+#define SNARK_IMAGING_APPLICATIONS_PIPELINE_STATISTICS_H_
+
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <boost/array.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <comma/base/types.h>
+
+namespace snark { namespace imaging { namespace applications {
+
+/// per-stage timing statistics for image processing pipelines,
+/// periodically written as csv to stderr or a file, see usage() for output format
+class pipeline_statistics
+{
+    public:
+        enum { histogram_size = 24 };
+
+        /// constructor
+        /// @param period how often to output statistics
+        /// @param filename output file; if empty, output to stderr
+        pipeline_statistics( const boost::posix_time::time_duration& period, const std::string& filename = "" );
+
+        /// add named stage, return its index
+        unsigned int add_stage( const std::string& name );
+
+        /// record time spent in a given stage; thread-safe
+        void add( unsigned int stage, const boost::posix_time::time_duration& elapsed );
+
+        /// record end-to-end latency of an output frame
+        void add_latency( const boost::posix_time::time_duration& latency );
+
+        /// record reader state
+        void set_reader( unsigned int queue_size, comma::uint64 discarded );
+
+        /// write statistics, if period elapsed since last dump
+        void write_if_due( const boost::posix_time::ptime& now = boost::posix_time::microsec_clock::universal_time() );
+
+        /// write statistics and reset counters
+        void write( const boost::posix_time::ptime& now = boost::posix_time::microsec_clock::universal_time() );
+
+        /// return usage
+        static std::string usage();
+
+    private:
+        struct stage
+        {
+            std::string name;
+            comma::uint64 count;
+            comma::uint64 total;
+            comma::uint64 min;
+            comma::uint64 max;
+            boost::array< comma::uint64, histogram_size > histogram;
+
+            stage( const std::string& name = "" );
+            void add( comma::int64 microseconds );
+            void reset();
+        };
+        void write_stage_( const boost::posix_time::ptime& t, const stage& s, unsigned int queue, comma::uint64 discarded );
+
+        boost::posix_time::time_duration period_;
+        boost::posix_time::ptime last_;
+        boost::scoped_ptr< std::ofstream > ofstream_;
+        std::ostream* os_;
+        boost::mutex mutex_;
+        std::vector< stage > stages_;
+        stage latency_;
+        unsigned int queue_size_;
+        comma::uint64 discarded_;
+        comma::uint64 last_discarded_;
+};
+
+} } }
+
+#endif // SNARK_IMAGING_APPLICATIONS_PIPELINE_STATISTICS_H_
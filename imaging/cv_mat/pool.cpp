@@ -0,0 +1,64 @@
+// This file is part of snark, a generic and flexible library for robotics research
+// Copyright (c) 2011 The University of Sydney
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. All advertising materials mentioning features or use of this software
+//    must display the following acknowledgement:
+//    This product includes software developed by the The University of Sydney.
+// 4. Neither the name of the The University of Sydney nor the
+//    names of its contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+//
+// NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+// GRANTED BY THIS LICENSE.  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+// HOLDERS AND CONTRIBUTORS \"AS IS\" AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+// BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+// OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+// IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "./pool.h"
+
+namespace snark{ namespace cv_mat {
+
+static bool is_released_( const cv::Mat& m ) // true, if only the pool refers to the buffer
+{
+    #if CV_MAJOR_VERSION >= 3
+    return m.u && m.u->refcount == 1;
+    #else
+    return m.refcount && *m.refcount == 1;
+    #endif
+}
+
+pool::pool( unsigned int size ) : capacity_( size ) { mats_.reserve( size ); }
+
+cv::Mat pool::get( int rows, int cols, int type )
+{
+    boost::mutex::scoped_lock lock( mutex_ );
+    int released = -1;
+    for( std::size_t i = 0; i < mats_.size(); ++i )
+    {
+        if( !is_released_( mats_[i] ) ) { continue; }
+        if( mats_[i].rows == rows && mats_[i].cols == cols && mats_[i].type() == type ) { return mats_[i]; }
+        if( released < 0 ) { released = i; }
+    }
+    if( released >= 0 ) { mats_[ released ] = cv::Mat( rows, cols, type ); return mats_[ released ]; } // image size changed
+    if( mats_.size() < capacity_ ) { mats_.push_back( cv::Mat( rows, cols, type ) ); return mats_.back(); }
+    return cv::Mat( rows, cols, type );
+}
+
+} }  // namespace snark{ namespace cv_mat {
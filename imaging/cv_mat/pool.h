@@ -0,0 +1,71 @@
+// This file is part of snark, a generic and flexible library for robotics research
+// Copyright (c) 2011 The University of Sydney
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. All advertising materials mentioning features or use of this software
+//    must display the following acknowledgement:
+//    This product includes software developed by the The University of Sydney.
+// 4. Neither the name of the The University of Sydney nor the
+//    names of its contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+//
+// NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+// GRANTED BY THIS LICENSE.  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+// HOLDERS AND CONTRIBUTORS \"AS IS\" AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+// BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+// OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+// IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef SNARK_IMAGING_CVMAT_POOL_H_
+#define SNARK_IMAGING_CVMAT_POOL_H_
+
+#include <vector>
+#include <boost/thread/mutex.hpp>
+#include <opencv2/core/core.hpp>
+
+namespace snark{ namespace cv_mat {
+
+/// pool of reusable image buffers
+///
+/// get() returns a cv::Mat sharing its data with a buffer owned by the pool;
+/// the buffer is handed out again only after all cv::Mat instances referring
+/// to it outside of the pool have been released, which avoids allocating
+/// a new frame for each image read
+class pool
+{
+    public:
+        /// constructor
+        /// @param size maximum number of buffers kept in the pool; if all of them
+        ///             are in use, get() allocates a buffer not owned by the pool
+        pool( unsigned int size = 16 );
+
+        /// return image with given size and type, reusing a released buffer if possible
+        cv::Mat get( int rows, int cols, int type );
+
+        /// number of buffers currently owned by the pool
+        std::size_t size() const { return mats_.size(); }
+
+    private:
+        unsigned int capacity_;
+        std::vector< cv::Mat > mats_;
+        boost::mutex mutex_;
+};
+
+} }  // namespace snark{ namespace cv_mat {
+
+#endif // SNARK_IMAGING_CVMAT_POOL_H_
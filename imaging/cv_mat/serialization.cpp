@@ -32,6 +32,10 @@
 
 
 #include <sstream>
+#ifndef WIN32
+#include <errno.h>
+#include <sys/uio.h>
+#endif
 #include <comma/base/exception.h>
 #include <comma/csv/binary.h>
 #include <comma/string/string.h>
@@ -157,6 +161,8 @@ std::size_t serialization::size( const std::pair< boost::posix_time::ptime, cv::
     return size( m.second );
 }
 
+std::size_t serialization::header_size() const { return m_binary ? m_binary->format().size() : 0; }
+
 std::pair< boost::posix_time::ptime, cv::Mat > serialization::read( std::istream& is )
 {
     header h;
@@ -174,7 +180,7 @@ std::pair< boost::posix_time::ptime, cv::Mat > serialization::read( std::istream
         h = m_header;
     }
     p.first = h.timestamp;
-    p.second = cv::Mat( h.rows, h.cols, h.type );
+    p.second = m_pool.get( h.rows, h.cols, h.type );
     std::size_t size = p.second.dataend - p.second.datastart;
     is.read( reinterpret_cast< char* >( p.second.datastart ), size );
     int count = is.gcount();
@@ -200,6 +206,45 @@ void serialization::write( std::ostream& os, const std::pair< boost::posix_time:
     os.flush();
 }
 
+#ifndef WIN32
+bool serialization::write( int fd, const std::pair< boost::posix_time::ptime, cv::Mat >& m )
+{
+    struct iovec iov[2];
+    int count = 0;
+    if( m_binary )
+    {
+        header h( m );
+        m_binary->put( h, &m_buffer[0] );
+        iov[count].iov_base = &m_buffer[0];
+        iov[count].iov_len = m_buffer.size();
+        ++count;
+    }
+    if( !m_headerOnly )
+    {
+        iov[count].iov_base = const_cast< unsigned char* >( m.second.datastart );
+        iov[count].iov_len = m.second.dataend - m.second.datastart;
+        ++count;
+    }
+    struct iovec* v = iov;
+    while( count > 0 )
+    {
+        ssize_t written = ::writev( fd, v, count );
+        if( written < 0 )
+        {
+            if( errno == EINTR ) { continue; }
+            return false;
+        }
+        for( ; count > 0 && std::size_t( written ) >= v->iov_len; written -= v->iov_len, ++v, --count );
+        if( count > 0 ) // partial write
+        {
+            v->iov_base = static_cast< char* >( v->iov_base ) + written;
+            v->iov_len -= written;
+        }
+    }
+    return true;
+}
+#endif
+
 static const std::string cvmat_usage_impl_()
 {
     std::ostringstream oss;
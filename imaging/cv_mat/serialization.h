@@ -41,6 +41,7 @@
 #include <comma/base/types.h>
 #include <comma/csv/binary.h>
 #include <comma/visiting/traits.h>
+#include <snark/imaging/cv_mat/pool.h>
 
 
 namespace snark{ namespace cv_mat {
@@ -109,17 +110,29 @@ class serialization
         /// same as above
         std::size_t size( const std::pair< boost::posix_time::ptime, cv::Mat >& m ) const;
 
+        /// return header size, 0 if no header
+        std::size_t header_size() const;
+
         /// read from stream, if eof, return empty cv::Mat
+        /// @note image data is read directly into a buffer from the internal pool,
+        ///       which is reused once the returned cv::Mat and all its copies are released
         std::pair< boost::posix_time::ptime, cv::Mat > read( std::istream& is );
 
         /// write to stream
         void write( std::ostream& os, const std::pair< boost::posix_time::ptime, cv::Mat >& m );
 
+        #ifndef WIN32
+        /// write header and data to file descriptor in a single gather write, bypassing stream buffers
+        /// @return false, if write failed (e.g. broken pipe)
+        bool write( int fd, const std::pair< boost::posix_time::ptime, cv::Mat >& m );
+        #endif
+
     private:
         boost::scoped_ptr< comma::csv::binary< header > > m_binary;
         std::vector< char > m_buffer;
         bool m_headerOnly;
         header m_header; /// default header
+        pool m_pool;
 };
 
 } }  // namespace snark{ namespace cv_mat {
@@ -45,28 +45,30 @@ frequency_domain::frequency_domain( const cv::Mat& mask ):
     shift( m_mask );
 }
 
+/// expand buffers and mask to optimal dft size for a given image size
+void frequency_domain::prepare_( const cv::Size& size )
+{
+    if( size == m_size ) { return; }
+    int m = cv::getOptimalDFTSize( size.height );
+    int n = cv::getOptimalDFTSize( size.width ); // on the border add zero values
+    m_padded = cv::Mat::zeros( m, n, CV_32F ); // only the image area gets overwritten, the border stays zero
+    cv::copyMakeBorder( m_mask, m_paddedMask, 0, m - m_mask.rows, 0, n - m_mask.cols, cv::BORDER_CONSTANT, cv::Scalar::all(0) );
+    m_masked = cv::Mat::zeros( m, n, CV_32FC2 ); // only the mask area gets overwritten, the rest stays zero
+    m_size = size;
+}
+
 /// transform image into frequency domain, apply window and transform back to space domain
 cv::Mat frequency_domain::filter( const cv::Mat& image, const cv::Mat& mask )
 {
     double maxValue;
     cv::minMaxIdx( image, NULL, &maxValue );
-    cv::Mat padded;
-    cv::Mat paddedMask;                      //expand input image to optimal size
-    int m = cv::getOptimalDFTSize( image.rows );
-    int n = cv::getOptimalDFTSize( image.cols ); // on the border add zero values
-    cv::copyMakeBorder( image, padded, 0, m - image.rows, 0, n - image.cols, cv::BORDER_CONSTANT, cv::Scalar::all(0) );
-    cv::copyMakeBorder( m_mask, paddedMask, 0, m - m_mask.rows, 0, n - m_mask.cols, cv::BORDER_CONSTANT, cv::Scalar::all(0) );
-
-    cv::Mat planes[] = { cv::Mat_<float>(padded), cv::Mat::zeros(padded.size(), CV_32F) };
-    cv::merge( planes, 2, m_complexImage );         // Add to the expanded another plane with zeros
-    cv::dft( m_complexImage, m_complexImage );            // this way the result may fit in the source matrix
-    
-    cv::Mat masked;
-    m_complexImage.copyTo( masked, paddedMask );
-    
-    cv::Mat inverse;
-    cv::dft( masked, inverse, cv::DFT_INVERSE | cv::DFT_REAL_OUTPUT );
-    cv::Mat abs = cv::abs( inverse );
+    prepare_( image.size() );
+    cv::Mat roi = m_padded( cv::Rect( 0, 0, image.cols, image.rows ) );
+    image.convertTo( roi, CV_32F );
+    cv::dft( m_padded, m_complexImage, cv::DFT_COMPLEX_OUTPUT, image.rows ); // real input, rows below the image are zero
+    m_complexImage.copyTo( m_masked, m_paddedMask );
+    cv::dft( m_masked, m_inverse, cv::DFT_INVERSE | cv::DFT_REAL_OUTPUT );
+    cv::Mat abs = cv::abs( m_inverse );
     if( mask.rows != 0 )
     {
         cv::Mat maskF;// = cv::Mat_<float>( mask );
@@ -88,6 +90,14 @@ cv::Mat frequency_domain::filter( const cv::Mat& image, const cv::Mat& mask )
     return result;
 }
 
+/// filter a batch of images of the same size, reusing transform buffers
+std::vector< cv::Mat > frequency_domain::filter( const std::vector< cv::Mat >& images, const cv::Mat& mask )
+{
+    std::vector< cv::Mat > filtered( images.size() );
+    for( std::size_t i = 0; i < images.size(); ++i ) { filtered[i] = filter( images[i], mask ); }
+    return filtered;
+}
+
 /// get the magnitude of the image in frequency domain
 cv::Mat frequency_domain::magnitude() const
 {    
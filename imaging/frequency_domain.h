@@ -34,22 +34,32 @@
 #ifndef SNARK_IMAGING_FREQUENCY_DOMAIN_H
 #define SNARK_IMAGING_FREQUENCY_DOMAIN_H
 
+#include <vector>
 #include <opencv2/core/core.hpp>
 
 namespace snark { namespace imaging {
 
 /// filter the image in frequency domain
+/// @note padded size, padded mask and transform buffers are computed once
+///       per image size and reused for all the following images of that size
 class frequency_domain
 {
 public:
     frequency_domain( const cv::Mat& mask );
     cv::Mat filter( const cv::Mat& image, const cv::Mat& mask = cv::Mat() );
+    std::vector< cv::Mat > filter( const std::vector< cv::Mat >& images, const cv::Mat& mask = cv::Mat() );
     cv::Mat magnitude() const;
 
 private:
     static void shift( cv::Mat& image );
+    void prepare_( const cv::Size& size );
     cv::Mat m_complexImage;
     cv::Mat m_mask;
+    cv::Size m_size; /// image size for which the buffers below are prepared
+    cv::Mat m_padded;
+    cv::Mat m_paddedMask;
+    cv::Mat m_masked;
+    cv::Mat m_inverse;
 };
 
 } } 
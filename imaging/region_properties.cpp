@@ -32,40 +32,118 @@
 
 
 #include <cmath>
-#include <boost/geometry.hpp>
-#include <boost/geometry/geometries/polygon.hpp>
-#include <boost/geometry/geometries/adapted/boost_tuple.hpp>
-#include <boost/foreach.hpp>
+#include <vector>
 #include <Eigen/Core>
 #include <snark/imaging/region_properties.h>
 #include <comma/base/exception.h>
+#include <comma/base/types.h>
 
 #include <opencv2/imgproc/imgproc.hpp>
 #include <opencv2/highgui/highgui.hpp>
 
-BOOST_GEOMETRY_REGISTER_BOOST_TUPLE_CS( cs::cartesian )
-
 namespace snark{ namespace imaging {
 
 /// compute the area of a polygon and its convex hull
 /// @param points polygon points
-/// @param area area of the polygon
+/// @param area area of the polygon, positive for clockwise contours
 /// @param convexArea area of the convex hull
 void compute_area( const std::vector< cv::Point >& points, double& area, double& convexArea )
 {
-    boost::geometry::model::polygon< boost::tuple< double, double > > polygon;
-    for( unsigned int i = 0; i < points.size(); i++ )
+    area = -cv::contourArea( points, true );
+    std::vector< cv::Point > hull;
+    cv::convexHull( points, hull );
+    convexArea = cv::contourArea( hull );
+}
+
+/// raw moments of a blob accumulated in a single pass over the image
+struct moment_sums
+{
+    comma::int64 m00, m10, m01, m20, m11, m02;
+
+    moment_sums() : m00( 0 ), m10( 0 ), m01( 0 ), m20( 0 ), m11( 0 ), m02( 0 ) {}
+
+    void add( comma::int64 x, comma::int64 y ) { ++m00; m10 += x; m01 += y; m20 += x * x; m11 += x * y; m02 += y * y; }
+
+    /// same as cv::moments of the blob image cropped at the given origin (sums are exact, thus the result is the same)
+    cv::Moments moments( const cv::Point& origin ) const
     {
-        boost::geometry::append( polygon, boost::make_tuple( points[i].x, points[i].y ) );
+        comma::int64 x = origin.x;
+        comma::int64 y = origin.y;
+        return cv::Moments( m00
+                          , m10 - x * m00
+                          , m01 - y * m00
+                          , m20 - 2 * x * m10 + x * x * m00
+                          , m11 - x * m01 - y * m10 + x * y * m00
+                          , m02 - 2 * y * m01 + y * y * m00
+                          , 0, 0, 0, 0 );
     }
-    boost::geometry::append( polygon, boost::make_tuple( points[0].x, points[0].y ) ); // close polygon
+};
 
-    area = boost::geometry::area( polygon );
+static unsigned int find_( std::vector< unsigned int >& parents, unsigned int i )
+{
+    while( parents[i] != i ) { i = parents[i] = parents[ parents[i] ]; }
+    return i;
+}
 
-    boost::geometry::model::polygon< boost::tuple<double, double> > hull;
-    boost::geometry::convex_hull( polygon, hull );
+static void unite_( std::vector< unsigned int >& parents, unsigned int i, unsigned int j )
+{
+    i = find_( parents, i );
+    j = find_( parents, j );
+    if( i < j ) { parents[j] = i; } else if( j < i ) { parents[i] = j; }
+}
 
-    convexArea = boost::geometry::area( hull );
+/// set non-zero pixels and all holes enclosed by them to 1, i.e. the pixels
+/// covered by the external contours drawn filled
+static cv::Mat filled_( const cv::Mat& binary )
+{
+    cv::Mat padded = cv::Mat::zeros( binary.rows + 2, binary.cols + 2, CV_8UC1 );
+    cv::Mat inner = padded( cv::Rect( 1, 1, binary.cols, binary.rows ) );
+    inner.setTo( cv::Scalar( 1 ), binary );
+    cv::floodFill( padded, cv::Point( 0, 0 ), cv::Scalar( 2 ) ); // 4-connected background, as in cv::findContours
+    return inner != 2;
+}
+
+/// label 8-connected components of non-zero pixels in two passes with union-find
+/// and accumulate moments of each component
+/// @return labels image; sums are indexed by label, label 0 is background
+static std::vector< unsigned int > label_( const cv::Mat& filled, std::vector< moment_sums >& sums )
+{
+    std::vector< unsigned int > labels( filled.rows * filled.cols, 0 );
+    std::vector< unsigned int > parents( 1, 0 );
+    for( int y = 0; y < filled.rows; ++y )
+    {
+        const unsigned char* row = filled.ptr< unsigned char >( y );
+        unsigned int* current = &labels[ y * filled.cols ];
+        const unsigned int* previous = y == 0 ? NULL : current - filled.cols;
+        for( int x = 0; x < filled.cols; ++x )
+        {
+            if( !row[x] ) { continue; }
+            unsigned int neighbours[4] = { x > 0 ? current[ x - 1 ] : 0
+                                         , previous && x > 0 ? previous[ x - 1 ] : 0
+                                         , previous ? previous[x] : 0
+                                         , previous && x + 1 < filled.cols ? previous[ x + 1 ] : 0 };
+            unsigned int label = 0;
+            for( unsigned int k = 0; k < 4; ++k )
+            {
+                if( neighbours[k] == 0 ) { continue; }
+                if( label == 0 ) { label = neighbours[k]; } else { unite_( parents, label, neighbours[k] ); }
+            }
+            if( label == 0 ) { label = parents.size(); parents.push_back( label ); }
+            current[x] = label;
+        }
+    }
+    sums.assign( parents.size(), moment_sums() );
+    for( int y = 0; y < filled.rows; ++y )
+    {
+        unsigned int* current = &labels[ y * filled.cols ];
+        for( int x = 0; x < filled.cols; ++x )
+        {
+            if( current[x] == 0 ) { continue; }
+            current[x] = find_( parents, current[x] );
+            sums[ current[x] ].add( x, y );
+        }
+    }
+    return labels;
 }
 
 /// constructor
@@ -88,15 +166,17 @@ region_properties::region_properties ( const cv::Mat& image, double minArea ):
     }
 //     cv::Mat closed;
 //     cv::morphologyEx( binary, closed, cv::MORPH_CLOSE, cv::Mat::ones( 3, 3, CV_8U) );
+    std::vector< moment_sums > sums;
+    std::vector< unsigned int > labels = label_( filled_( binary ), sums );
     std::vector< std::vector<cv::Point> > contours;
-    cv::findContours( binary, contours, CV_RETR_EXTERNAL, CV_CHAIN_APPROX_SIMPLE );
+    cv::Mat contoured = binary.clone(); // cv::findContours modifies its input
+    cv::findContours( contoured, contours, CV_RETR_EXTERNAL, CV_CHAIN_APPROX_SIMPLE );
     
     for( unsigned int i = 0; i < contours.size(); i++ )
     {
-        binary = cv::Scalar(0);
-        cv::drawContours( binary, contours, i, cv::Scalar(0xFF), CV_FILLED );
+        const moment_sums& s = sums[ labels[ contours[i][0].y * binary.cols + contours[i][0].x ] ];
         cv::Rect rect = cv::boundingRect( cv::Mat( contours[i]) );
-        cv::Moments moments = cv::moments( binary( rect ), true );
+        cv::Moments moments = s.moments( rect.tl() );
         double x = moments.m10/moments.m00;
         double y = moments.m01/moments.m00;
         double area = moments.m00; // cv::countNonZero( binary( rect ) )
@@ -32,7 +32,9 @@
 
 
 #include <snark/imaging/stereo/point_cloud.h>
+#include <cmath>
 #include <iostream>
+#include <comma/base/exception.h>
 
 namespace snark { namespace imaging {
 
@@ -73,6 +75,60 @@ cv::Mat point_cloud::get ( const cv::Mat& Q, const cv::Mat& left, const cv::Mat&
     return points;
 }
 
+/// compute disparity and sparse point cloud
+void point_cloud::get( const cv::Mat& Q, const cv::Mat& left, const cv::Mat& right, sparse& points, const cv::Rect& roi, double min_range, double max_range )
+{
+    m_disparity = get_disparity( left, right );
+    reproject( Q, m_disparity, left, points, roi, min_range, max_range );
+}
+
+/// reproject valid disparities only, same arithmetic as cv::reprojectImageTo3D
+void point_cloud::reproject( const cv::Mat& Q, const cv::Mat& disparity, const cv::Mat& image, sparse& points, const cv::Rect& roi, double min_range, double max_range )
+{
+    if( disparity.type() != CV_16SC1 ) { COMMA_THROW( comma::exception, "expected disparity of type CV_16SC1, got " << disparity.type() ); }
+    if( ( image.type() != CV_8UC3 && image.type() != CV_8UC1 ) || image.size() != disparity.size() ) { COMMA_THROW( comma::exception, "expected image of type CV_8UC3 or CV_8UC1 of the same size as disparity" ); }
+    bool grey = image.type() == CV_8UC1;
+    static const double factor = 16.0; // sgbm disparity has a factor 16
+    static const double big_z = 10000; // reprojectImageTo3D marks missing values with z = 10000
+    cv::Mat_< double > q;
+    Q.convertTo( q, CV_64F );
+    double min_disparity;
+    cv::minMaxIdx( disparity, &min_disparity ); // as reprojectImageTo3D: missing values are equal to the minimum disparity
+    cv::Rect r = cv::Rect( 0, 0, disparity.cols, disparity.rows );
+    if( roi.area() > 0 ) { r &= roi; }
+    double min_squared = min_range * min_range;
+    double max_squared = max_range * max_range;
+    points.clear();
+    for( int i = r.y; i < r.y + r.height; ++i )
+    {
+        const short* d = disparity.ptr< short >( i ) + r.x;
+        const unsigned char* colour = image.ptr( i ) + r.x * image.channels();
+        double qx = q( 0, 1 ) * i + q( 0, 3 ) + q( 0, 0 ) * r.x;
+        double qy = q( 1, 1 ) * i + q( 1, 3 ) + q( 1, 0 ) * r.x;
+        double qz = q( 2, 1 ) * i + q( 2, 3 ) + q( 2, 0 ) * r.x;
+        double qw = q( 3, 1 ) * i + q( 3, 3 ) + q( 3, 0 ) * r.x;
+        for( int j = 0; j < r.width; ++j, ++d, colour += image.channels(), qx += q( 0, 0 ), qy += q( 1, 0 ), qz += q( 2, 0 ), qw += q( 3, 0 ) )
+        {
+            if( *d == min_disparity ) { continue; }
+            double iw = 1. / ( qw + q( 3, 2 ) * *d );
+            float z = ( qz + q( 2, 2 ) * *d ) * iw;
+            if( std::fabs( z ) >= big_z ) { continue; }
+            float x = ( qx + q( 0, 2 ) * *d ) * iw * factor;
+            float y = ( qy + q( 1, 2 ) * *d ) * iw * factor;
+            z *= factor;
+            if( max_range > 0 )
+            {
+                double squared = double( x ) * x + double( y ) * y + double( z ) * z;
+                if( squared < min_squared || squared >= max_squared ) { continue; }
+            }
+            points.x.push_back( x );
+            points.y.push_back( y );
+            points.z.push_back( z );
+            points.colours.push_back( grey ? cv::Vec3b( *colour, *colour, *colour ) : cv::Vec3b( colour[0], colour[1], colour[2] ) );
+        }
+    }
+}
+
 /// compute disparity only
 /// @param left rectified left image
 /// @param right rectified right image
@@ -34,6 +34,7 @@
 #ifndef SNARK_IMAGING_STEREO_POINT_CLOUD_H
 #define SNARK_IMAGING_STEREO_POINT_CLOUD_H
 
+#include <vector>
 #include <opencv2/calib3d/calib3d.hpp>
 
 namespace snark { namespace imaging {
@@ -42,10 +43,32 @@ namespace snark { namespace imaging {
 class point_cloud
 {
 public:
+    /// valid points only, as structure of arrays, in pixel order
+    struct sparse
+    {
+        std::vector< float > x;
+        std::vector< float > y;
+        std::vector< float > z;
+        std::vector< cv::Vec3b > colours; /// left image pixel colour, as in image (bgr); grey replicated
+
+        std::size_t size() const { return x.size(); }
+        void clear() { x.clear(); y.clear(); z.clear(); colours.clear(); }
+    };
+
     point_cloud( unsigned int channels = 3 );
     point_cloud( const cv::StereoSGBM& sgbm );
 
     cv::Mat get( const cv::Mat& Q, const cv::Mat& left, const cv::Mat& right );
+
+    /// compute disparity and reproject only valid disparities, without allocating a dense point image
+    /// @param roi region of interest in the left image; empty: whole image
+    /// @param min_range, max_range if max_range > 0, keep only points with range in [min_range, max_range)
+    void get( const cv::Mat& Q, const cv::Mat& left, const cv::Mat& right, sparse& points, const cv::Rect& roi = cv::Rect(), double min_range = 0, double max_range = 0 );
+
+    /// reproject valid pixels of sgbm disparity (CV_16SC1, fixed point with 4 fractional bits)
+    /// @note same points as reprojectImageTo3D with missing values handled, scaled by disparity factor 16
+    static void reproject( const cv::Mat& Q, const cv::Mat& disparity, const cv::Mat& image, sparse& points, const cv::Rect& roi = cv::Rect(), double min_range = 0, double max_range = 0 );
+
     cv::Mat get_disparity( const cv::Mat& left, const cv::Mat& right );
     /// get disparity after computing the point cloud
     const cv::Mat& disparity() const { return m_disparity; }
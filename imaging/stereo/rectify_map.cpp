@@ -32,12 +32,128 @@
 
 
 #include <snark/imaging/stereo/rectify_map.h>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#ifdef WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
 #include <opencv2/core/eigen.hpp>
 #include <opencv2/imgproc/imgproc.hpp>
 #include <iostream>
 
 namespace snark { namespace imaging {
 
+static std::string cache_directory_;
+
+static const char cache_magic_[] = "snark::imaging::rectify_map 1"; // change version, if cache layout changes
+
+/// header of cached matrix; data follows, padded to 8 bytes
+struct cached_mat_header
+{
+    comma::uint32 rows;
+    comma::uint32 cols;
+    comma::uint32 type;
+    comma::uint32 padding;
+};
+
+static void hash_( comma::uint64& h, const void* data, std::size_t size ) // fnv-1a
+{
+    const unsigned char* p = static_cast< const unsigned char* >( data );
+    for( std::size_t i = 0; i < size; ++i ) { h ^= p[i]; h *= 1099511628211ULL; }
+}
+
+static void hash_( comma::uint64& h, const cv::Mat& m )
+{
+    cv::Mat c = m.isContinuous() ? m : m.clone();
+    hash_( h, c.data, c.total() * c.elemSize() );
+}
+
+static std::string cache_filename_( comma::uint64 key )
+{
+    std::ostringstream oss;
+    oss << cache_directory_ << "/rectify-map." << std::hex << key << ".bin";
+    return oss.str();
+}
+
+static void write_( std::ostream& os, const cv::Mat& m )
+{
+    cv::Mat c = m.isContinuous() ? m : m.clone();
+    cached_mat_header h;
+    h.rows = c.rows;
+    h.cols = c.cols;
+    h.type = c.type();
+    h.padding = 0;
+    os.write( reinterpret_cast< const char* >( &h ), sizeof( h ) );
+    std::size_t size = c.total() * c.elemSize();
+    if( size > 0 ) { os.write( reinterpret_cast< const char* >( c.data ), size ); }
+    static const char zeros[8] = { 0 };
+    os.write( zeros, ( 8 - size % 8 ) % 8 );
+}
+
+static bool read_( const char*& p, const char* end, cv::Mat& m )
+{
+    if( p + sizeof( cached_mat_header ) > end ) { return false; }
+    cached_mat_header h;
+    ::memcpy( &h, p, sizeof( h ) );
+    p += sizeof( h );
+    std::size_t size = std::size_t( h.rows ) * h.cols * CV_ELEM_SIZE( h.type );
+    if( p + size > end ) { return false; }
+    m = size == 0 ? cv::Mat() : cv::Mat( h.rows, h.cols, h.type, const_cast< char* >( p ) );
+    p += size + ( 8 - size % 8 ) % 8;
+    return true;
+}
+
+void rectify_map::cache( const std::string& directory ) { cache_directory_ = directory; }
+
+bool rectify_map::load_( const std::string& filename, comma::uint64 key )
+{
+    if( !std::ifstream( filename.c_str() ).is_open() ) { return false; }
+    boost::interprocess::file_mapping file( filename.c_str(), boost::interprocess::read_only );
+    boost::shared_ptr< boost::interprocess::mapped_region > region( new boost::interprocess::mapped_region( file, boost::interprocess::copy_on_write ) );
+    const char* p = static_cast< const char* >( region->get_address() );
+    const char* end = p + region->get_size();
+    if( std::size_t( end - p ) < sizeof( cache_magic_ ) + sizeof( comma::uint64 ) ) { return false; }
+    if( ::memcmp( p, cache_magic_, sizeof( cache_magic_ ) ) != 0 ) { return false; }
+    p += sizeof( cache_magic_ );
+    comma::uint64 k;
+    ::memcpy( &k, p, sizeof( k ) );
+    if( k != key ) { return false; }
+    p += sizeof( k );
+    p += ( 8 - ( sizeof( cache_magic_ ) + sizeof( k ) ) % 8 ) % 8;
+    cv::Mat R1, R2, P1, P2, Q, map11, map12, map21, map22;
+    if(    !read_( p, end, R1 ) || !read_( p, end, R2 ) || !read_( p, end, P1 ) || !read_( p, end, P2 ) || !read_( p, end, Q )
+        || !read_( p, end, map11 ) || !read_( p, end, map12 ) || !read_( p, end, map21 ) || !read_( p, end, map22 ) ) { return false; }
+    m_R1 = R1; m_R2 = R2; m_P1 = P1; m_P2 = P2; m_Q = Q;
+    m_map11 = map11; m_map12 = map12; m_map21 = map21; m_map22 = map22;
+    m_cached = region;
+    return true;
+}
+
+void rectify_map::save_( const std::string& filename, comma::uint64 key ) const
+{
+    std::ostringstream oss;
+    oss << filename << "." << ::getpid() << ".tmp";
+    std::string temporary = oss.str(); // write and rename, since several processes may run at the same time
+    {
+        std::ofstream ofs( temporary.c_str(), std::ios::binary );
+        if( !ofs.is_open() ) { std::cerr << "rectify_map: warning: failed to open \"" << temporary << "\", rectification will not be cached" << std::endl; return; }
+        ofs.write( cache_magic_, sizeof( cache_magic_ ) );
+        ofs.write( reinterpret_cast< const char* >( &key ), sizeof( key ) );
+        static const char zeros[8] = { 0 };
+        ofs.write( zeros, ( 8 - ( sizeof( cache_magic_ ) + sizeof( key ) ) % 8 ) % 8 );
+        write_( ofs, m_R1 ); write_( ofs, m_R2 ); write_( ofs, m_P1 ); write_( ofs, m_P2 ); write_( ofs, m_Q );
+        write_( ofs, m_map11 ); write_( ofs, m_map12 ); write_( ofs, m_map21 ); write_( ofs, m_map22 );
+        if( !ofs.good() ) { std::cerr << "rectify_map: warning: failed to write \"" << temporary << "\", rectification will not be cached" << std::endl; ofs.close(); std::remove( temporary.c_str() ); return; }
+    }
+    if( std::rename( temporary.c_str(), filename.c_str() ) != 0 ) { std::remove( temporary.c_str() ); }
+}
+
 /// constructor from parameters
 rectify_map::rectify_map ( const Eigen::Matrix3d& leftCamera, const Vector5d& leftDistortion, const Eigen::Matrix3d& rightCamera, const Vector5d& rightDistortion,
                            unsigned int imageWidth, unsigned int imageHeight, const Eigen::Matrix3d& rotation, const Eigen::Vector3d& translation, bool rectified )
@@ -51,10 +167,29 @@ rectify_map::rectify_map ( const Eigen::Matrix3d& leftCamera, const Vector5d& le
     cv::eigen2cv( rotation, m_rotation );
     cv::eigen2cv( translation, m_translation );
 
+    bool remap = !rectified && ( leftDistortion.norm() > 1e-5 || rightDistortion.norm() > 1e-5 || !rotation.isApprox( Eigen::Matrix3d::Identity() ) );
+    std::string cache_filename;
+    comma::uint64 key = 14695981039346656037ULL;
+    if( !cache_directory_.empty() )
+    {
+        hash_( key, cache_magic_, sizeof( cache_magic_ ) );
+        hash_( key, m_leftCamera );
+        hash_( key, m_leftDistortion );
+        hash_( key, m_rightCamera );
+        hash_( key, m_rightDistortion );
+        hash_( key, m_rotation );
+        hash_( key, m_translation );
+        comma::uint32 geometry[3] = { imageWidth, imageHeight, remap };
+        hash_( key, geometry, sizeof( geometry ) );
+        cache_filename = cache_filename_( key );
+        try { if( load_( cache_filename, key ) ) { return; } }
+        catch( std::exception& ex ) { std::cerr << "rectify_map: warning: failed to load \"" << cache_filename << "\": " << ex.what() << "; recomputing" << std::endl; }
+    }
+
     cv::stereoRectify( m_leftCamera, m_leftDistortion, m_rightCamera, m_rightDistortion, m_imageSize, m_rotation, m_translation,
                        m_R1, m_R2, m_P1, m_P2, m_Q );
 
-    if ( !rectified && ( leftDistortion.norm() > 1e-5 || rightDistortion.norm() > 1e-5 || !rotation.isApprox( Eigen::Matrix3d::Identity() ) ) )
+    if ( remap )
     {
         cv::initUndistortRectifyMap( m_leftCamera, m_leftDistortion, m_R1, m_P1, m_imageSize, CV_16SC2, m_map11, m_map12 );
         cv::initUndistortRectifyMap( m_rightCamera, m_rightDistortion, m_R2, m_P2, m_imageSize, CV_16SC2, m_map21, m_map22);
@@ -63,6 +198,7 @@ rectify_map::rectify_map ( const Eigen::Matrix3d& leftCamera, const Vector5d& le
     {
 //     no rectification is needed ( pre-rectified images ), only compute Q
     }
+    if( !cache_filename.empty() ) { save_( cache_filename, key ); }
 }
 
 /// constructor from maps
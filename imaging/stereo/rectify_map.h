@@ -34,8 +34,13 @@
 #ifndef SNARK_IMAGING_STEREO_RECTIFY_MAP_H
 #define SNARK_IMAGING_STEREO_RECTIFY_MAP_H
 
+#include <string>
+#include <boost/shared_ptr.hpp>
 #include <opencv2/calib3d/calib3d.hpp>
 #include <Eigen/Core>
+#include <comma/base/types.h>
+
+namespace boost { namespace interprocess { class mapped_region; } }
 
 namespace snark { namespace imaging {
 
@@ -52,6 +57,11 @@ public:
     rectify_map( const Eigen::Matrix3d& leftCamera, const Eigen::Matrix3d& rightCamera, const Eigen::Vector3d& translation,
                  const cv::Mat& left_x, const cv::Mat& left_y, const cv::Mat& right_x, const cv::Mat& right_y, bool rectified = false );
 
+    /// cache rectification in files in given directory, keyed by calibration; empty: do not cache
+    /// maps are computed once and memory-mapped on subsequent constructions with the same calibration,
+    /// e.g. when an application runs once per image pair
+    static void cache( const std::string& directory );
+
     /// return the Q matrix
     const cv::Mat& Q() const { return m_Q; }
     
@@ -82,6 +92,11 @@ private:
     cv::Mat m_map12;
     cv::Mat m_map21;
     cv::Mat m_map22;
+
+    boost::shared_ptr< boost::interprocess::mapped_region > m_cached; /// keeps cached matrices mapped
+
+    bool load_( const std::string& filename, comma::uint64 key );
+    void save_( const std::string& filename, comma::uint64 key ) const;
 };
 
 } }
@@ -30,6 +30,8 @@
 // OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
 // IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
+#include <algorithm>
+#include <cmath>
 #include <boost/thread/thread_time.hpp>
 #include <snark/math/rotation_matrix.h>
 #include <snark/math/applications/frame.h>
@@ -37,11 +39,20 @@
 
 namespace snark{ namespace applications {
 
+frame::sample::sample( const position_type& nav )
+    : nav( nav )
+    , rotation( snark::rotation_matrix::rotation( nav.value.orientation ) )
+    , quaternion( rotation )
+{
+}
+
 frame::frame( const position& p, bool to, bool interpolate, bool rotation_present )
     : outputframe( false )
     , m_to( to )
     , m_interpolate( interpolate )
     , m_rotation( ::Eigen::Matrix3d::Identity() )
+    , m_out_of_order( false )
+    , m_cached( false )
     , m_discarded( false )
     , rotation_present_( rotation_present )
 {
@@ -54,6 +65,8 @@ frame::frame( const comma::csv::options& options, bool discardOutOfOrder, boost:
     , m_interpolate( interpolate )
     , m_rotation( ::Eigen::Matrix3d::Identity() )
     , m_istream( new comma::io::istream( options.filename, options.binary() ? comma::io::mode::binary : comma::io::mode::ascii, comma::io::mode::blocking ) )
+    , m_out_of_order( false )
+    , m_cached( false )
     , m_discardOutOfOrder( discardOutOfOrder )
     , m_maxGap( maxGap )
     , rotation_present_( rotation_present )
@@ -61,11 +74,25 @@ frame::frame( const comma::csv::options& options, bool discardOutOfOrder, boost:
     m_is.reset( new comma::csv::input_stream< position_type >( *( *m_istream )(), options ) );
     const position_type* p = m_is->read(); // todo: maybe not very good, move to value()
     if( p == NULL ) { COMMA_THROW( comma::exception, "failed to read from " << options.filename ); }
-    m_pair.first = *p;
-    set_position( p->value );
+    m_pair.first = sample( *p );
+    set_position( m_pair.first );
     p = m_is->read(); // todo: maybe not very good, move to value()
     if( p == NULL ) { COMMA_THROW( comma::exception, "failed to read from " << options.filename ); }
-    m_pair.second = *p;
+    m_pair.second = sample( *p );
+    set_interval();
+}
+
+frame::frame( const ::Eigen::Affine3d& transform, bool rotation_present )
+    : outputframe( false )
+    , m_to( false )
+    , m_interpolate( true )
+    , m_rotation( transform.linear() )
+    , m_transform( transform )
+    , m_out_of_order( false )
+    , m_cached( false )
+    , m_discarded( false )
+    , rotation_present_( rotation_present )
+{
 }
 
 frame::~frame()
@@ -76,73 +103,185 @@ frame::~frame()
 const frame::point_type* frame::converted( const point_type& rhs )
 {
     if( !m_is ) { return &convert( rhs ); }
+    if( m_trajectory ) { return converted( rhs, m_converted, m_discarded, outputframe ? &m_position : NULL ); }
     m_discarded = false;
-    while( rhs.t >= m_pair.first.t )
+    while( rhs.t >= m_pair.first.nav.t )
     {
-        if( ( rhs.t <= m_pair.second.t ) )
+        if( ( rhs.t <= m_pair.second.nav.t ) )
         {
+            if( m_cached && rhs.t == m_last ) { return &convert( rhs ); } // same nav interval and time: transform is still valid
             if( m_interpolate )
             {
-                if( m_pair.first.t == m_pair.second.t )
+                if( m_pair.first.nav.t == m_pair.second.nav.t )
                 {
-                    set_position( m_pair.second.value );
+                    set_position( m_pair.second );
                 }
                 else
                 {
-                    double factor = double( ( rhs.t - m_pair.first.t ).total_microseconds() ) / ( m_pair.second.t - m_pair.first.t ).total_microseconds();
-                    position p( m_pair.first.value.coordinates * ( 1 - factor ) + m_pair.second.value.coordinates * factor,
-                                m_pair.first.value.orientation * ( 1 - factor ) + m_pair.second.value.orientation * factor );
-                    set_position( p ); // TODO do interpolation with eigen ?
+                    interpolate( double( ( rhs.t - m_pair.first.nav.t ).total_microseconds() ) / ( m_pair.second.nav.t - m_pair.first.nav.t ).total_microseconds() );
                 }
             }
             else
             {
-                // keep the first point or take the second point if closer
-                if( ( rhs.t - m_pair.first.t ).total_microseconds() * 2u  > ( m_pair.second.t - m_pair.first.t ).total_microseconds() )
-                {
-                    set_position( m_pair.second.value );
-                }
+                // take the closer of the two points; points going back in time may be closer to the first point again
+                bool second = ( rhs.t - m_pair.first.nav.t ).total_microseconds() * 2u  > ( m_pair.second.nav.t - m_pair.first.nav.t ).total_microseconds();
+                set_position( second ? m_pair.second : m_pair.first );
             }
+            m_cached = true;
+            m_last = rhs.t;
             return &convert( rhs );
         }
+        m_cached = false;
         do
         {
             const position_type* p = m_is->read();
             if( p == NULL ) { return NULL; }
             m_pair.first = m_pair.second;
-            m_pair.second = *p;
-            if( !m_interpolate ) { set_position( m_pair.first.value ); }
+            m_pair.second = sample( *p );
+            if( !m_interpolate ) { set_position( m_pair.first ); }
         }
-        while( m_maxGap && ( m_pair.second.t - m_pair.first.t ) > *m_maxGap );
+        while( m_maxGap && ( m_pair.second.nav.t - m_pair.first.nav.t ) > *m_maxGap );
+        set_interval();
     }
-    if( !m_discardOutOfOrder ) { COMMA_THROW( comma::exception, "expected timestamp not earlier than " << boost::posix_time::to_iso_string( m_pair.first.t ) << "; got " << boost::posix_time::to_iso_string( rhs.t ) << "; use --discard" ); }
+    if( !m_discardOutOfOrder ) { COMMA_THROW( comma::exception, "expected timestamp not earlier than " << boost::posix_time::to_iso_string( m_pair.first.nav.t ) << "; got " << boost::posix_time::to_iso_string( rhs.t ) << "; use --discard" ); }
     m_discarded = true;
     return NULL;
 }
 
+void frame::preload( bool out_of_order )
+{
+    if( !m_is || m_trajectory ) { return; }
+    m_out_of_order = out_of_order;
+    m_trajectory.reset( new snark::applications::trajectory );
+    m_trajectory->push_back( m_pair.first.nav.t, m_pair.first.nav.value.coordinates, m_pair.first.nav.value.orientation );
+    m_trajectory->push_back( m_pair.second.nav.t, m_pair.second.nav.value.coordinates, m_pair.second.nav.value.orientation );
+    while( true )
+    {
+        const position_type* p = m_is->read();
+        if( p == NULL ) { break; }
+        m_trajectory->push_back( p->t, p->value.coordinates, p->value.orientation );
+    }
+    m_trajectory->commit();
+}
+
+bool frame::out_of_order( const boost::posix_time::ptime& t, const boost::posix_time::ptime& latest ) const
+{
+    if( !m_trajectory || m_out_of_order || latest.is_special() || t >= latest ) { return false; }
+    trajectory::const_iterator it = m_trajectory->interval( latest );
+    if( it == m_trajectory->end() || t >= it->t ) { return false; }
+    if( !m_discardOutOfOrder ) { COMMA_THROW( comma::exception, "expected timestamp not earlier than " << boost::posix_time::to_iso_string( it->t ) << "; got " << boost::posix_time::to_iso_string( t ) << "; use --discard" ); }
+    return true;
+}
+
+const frame::point_type* frame::converted( const point_type& rhs, point_type& result, bool& discarded, position* nav ) const
+{
+    discarded = false;
+    if( !m_is ) { convert( rhs, result, m_transform, m_rotation ); return &result; }
+    if( !m_trajectory ) { COMMA_THROW( comma::exception, "nav data not preloaded" ); }
+    ::Eigen::Vector3d coordinates;
+    ::Eigen::Quaterniond orientation;
+    switch( m_trajectory->pose( rhs.t, m_interpolate, m_maxGap, coordinates, orientation ) )
+    {
+        case trajectory::found:
+            break;
+        case trajectory::after:
+            if( !m_out_of_order ) { return NULL; } // end of nav data
+            // fall through
+        case trajectory::before:
+        case trajectory::gap:
+            if( !m_discardOutOfOrder ) { COMMA_THROW( comma::exception, "no nav data for timestamp " << boost::posix_time::to_iso_string( rhs.t ) << "; use --discard" ); }
+            discarded = true;
+            return NULL;
+    }
+    ::Eigen::Matrix3d rotation = orientation.toRotationMatrix();
+    if( nav ) { *nav = position( coordinates, snark::rotation_matrix::roll_pitch_yaw( rotation ) ); }
+    convert( rhs, result, transform( coordinates, rotation ), rotation );
+    return &result;
+}
+
 void frame::set_position( const position& p )
 {
     m_position = p;
-    m_translation.vector() = ::Eigen::Vector3d( p.coordinates );
-    m_rotation = snark::rotation_matrix::rotation( p.orientation );
-    m_transform = m_to
-                ? m_rotation.transpose() * m_translation.inverse()
-                : m_translation * m_rotation;
+    set_transform( p.coordinates, snark::rotation_matrix::rotation( p.orientation ) );
+}
+
+void frame::set_position( const sample& s )
+{
+    m_position = s.nav.value;
+    set_transform( s.nav.value.coordinates, s.rotation );
+}
+
+void frame::set_transform( const ::Eigen::Vector3d& coordinates, const ::Eigen::Matrix3d& rotation )
+{
+    m_translation.vector() = coordinates;
+    m_rotation = rotation;
+    m_transform = transform( coordinates, rotation );
+}
+
+::Eigen::Affine3d frame::transform( const ::Eigen::Vector3d& coordinates, const ::Eigen::Matrix3d& rotation ) const
+{
+    ::Eigen::Translation3d translation( coordinates );
+    return m_to ? ::Eigen::Affine3d( rotation.transpose() * translation.inverse() )
+                : ::Eigen::Affine3d( translation * rotation );
+}
+
+void frame::set_interval()
+{
+    m_second = m_pair.second.quaternion;
+    double d = m_pair.first.quaternion.dot( m_second );
+    if( d < 0 ) { m_second.coeffs() = -m_second.coeffs(); d = -d; } // take the shorter arc
+    m_theta = std::acos( std::min( d, 1.0 ) );
+    m_sin_theta = std::sin( m_theta );
+}
+
+void frame::interpolate( double factor )
+{
+    ::Eigen::Matrix3d rotation = snark::applications::trajectory::slerp( m_pair.first.quaternion, m_second, m_theta, m_sin_theta, factor ).toRotationMatrix();
+    m_position.coordinates = m_pair.first.nav.value.coordinates * ( 1 - factor ) + m_pair.second.nav.value.coordinates * factor;
+    if( outputframe ) { m_position.orientation = snark::rotation_matrix::roll_pitch_yaw( rotation ); }
+    set_transform( m_position.coordinates, rotation );
 }
 
 
 const frame::point_type& frame::convert( const point_type& rhs )
 {
-    m_converted.t = rhs.t;
-    m_converted.value.coordinates = m_transform * rhs.value.coordinates;
+    convert( rhs, m_converted, m_transform, m_rotation );
+    return m_converted;
+}
+
+void frame::convert( const point_type& rhs, point_type& result, const ::Eigen::Affine3d& transform, const ::Eigen::Matrix3d& rotation ) const
+{
+    result.t = rhs.t;
+    result.value.coordinates = transform * rhs.value.coordinates;
     if( rotation_present_ )
     {
         Eigen::Matrix3d m = snark::rotation_matrix::rotation( rhs.value.orientation );
-        if( m_to ) { m = m_rotation.transpose() * m; }
-        else { m = m_rotation * m; }
-        m_converted.value.orientation = snark::rotation_matrix::roll_pitch_yaw( m );
+        if( m_to ) { m = rotation.transpose() * m; }
+        else { m = rotation * m; }
+        result.value.orientation = snark::rotation_matrix::roll_pitch_yaw( m );
     }
-    return m_converted;
+}
+
+std::vector< boost::shared_ptr< frame > > compose( const std::vector< boost::shared_ptr< frame > >& frames, bool rotation_present )
+{
+    std::vector< boost::shared_ptr< frame > > composed;
+    ::Eigen::Affine3d transform = ::Eigen::Affine3d::Identity();
+    bool is_static = false;
+    for( std::size_t i = 0; i < frames.size(); ++i )
+    {
+        if( frames[i]->is_static() )
+        {
+            transform = frames[i]->transform() * transform;
+            is_static = true;
+            continue;
+        }
+        if( is_static ) { composed.push_back( boost::shared_ptr< frame >( new frame( transform, rotation_present ) ) ); }
+        transform = ::Eigen::Affine3d::Identity();
+        is_static = false;
+        composed.push_back( frames[i] );
+    }
+    if( is_static ) { composed.push_back( boost::shared_ptr< frame >( new frame( transform, rotation_present ) ) ); }
+    return composed;
 }
 
 } } // namespace snark{ namespace applications {
@@ -39,6 +39,7 @@
 #include <sstream>
 #include <vector>
 #include <boost/optional.hpp>
+#include <boost/shared_ptr.hpp>
 
 #include <Eigen/Geometry>
 #include <comma/base/exception.h>
@@ -49,6 +50,7 @@
 #include <snark/math/rotation_matrix.h>
 #include <snark/visiting/eigen.h>
 #include "./timestamped.h"
+#include "./trajectory.h"
 
 namespace snark{ namespace applications {
 
@@ -105,10 +107,37 @@ class frame
 
         frame( const comma::csv::options& options, bool discardOutOfOrder, boost::optional< boost::posix_time::time_duration > maxGap, bool outputframe, bool to = false, bool interpolate = true, bool rotation_present = false );
 
+        /// static frame with given transform, e.g. composition of static frames
+        frame( const ::Eigen::Affine3d& transform, bool rotation_present = false );
+
         ~frame();
 
         const point_type* converted( const point_type& rhs );
 
+        /// same as converted( rhs ), but thread-safe; requires static frame or preloaded nav
+        /// @param nav if not null, set to nav position used for conversion
+        /// @return converted point or NULL, if there is no more nav data or point is discarded
+        const point_type* converted( const point_type& rhs, point_type& result, bool& discarded, position* nav = NULL ) const;
+
+        /// with preloaded nav, check a point against the latest point converted so far, as converted( rhs ) does
+        /// @return true, if t is earlier than the nav interval of latest and the point is to be discarded
+        /// @throw comma::exception, if such a point is not to be discarded
+        bool out_of_order( const boost::posix_time::ptime& t, const boost::posix_time::ptime& latest ) const;
+
+        /// read the rest of nav data into memory
+        /// @param out_of_order if true, points may come in any time order and points
+        ///                     outside of nav data are discarded rather than ending conversion
+        void preload( bool out_of_order = false );
+
+        /// preloaded nav data, if any
+        const snark::applications::trajectory* trajectory() const { return m_trajectory.get(); }
+
+        /// true, if frame does not depend on nav data
+        bool is_static() const { return !m_is; }
+
+        /// transform of static frame
+        const ::Eigen::Affine3d& transform() const { return m_transform; }
+
         bool discarded() const { return m_discarded; }
 
         const position& last() const { return m_position; }
@@ -116,10 +145,32 @@ class frame
         const bool outputframe;
 
     private:
+        /// nav sample with rotation precomputed once on reading
+        struct sample
+        {
+            sample() {}
+            sample( const position_type& nav );
+            position_type nav;
+            ::Eigen::Matrix3d rotation;
+            ::Eigen::Quaterniond quaternion;
+        };
+
         void set_position( const position& p );
 
+        void set_position( const sample& s );
+
+        void set_transform( const ::Eigen::Vector3d& coordinates, const ::Eigen::Matrix3d& rotation );
+
+        void set_interval();
+
+        void interpolate( double factor );
+
+        ::Eigen::Affine3d transform( const ::Eigen::Vector3d& coordinates, const ::Eigen::Matrix3d& rotation ) const;
+
         const point_type& convert( const point_type& rhs );
 
+        void convert( const point_type& rhs, point_type& result, const ::Eigen::Affine3d& transform, const ::Eigen::Matrix3d& rotation ) const;
+
         bool m_to; /// to frame if true, from frame else
         bool m_interpolate; /// interpolate nav data
         position m_position;
@@ -130,7 +181,14 @@ class frame
 
         boost::scoped_ptr< comma::io::istream > m_istream;
         boost::scoped_ptr< comma::csv::input_stream< position_type > > m_is;
-        std::pair< position_type, position_type > m_pair; /// nav pair
+        std::pair< sample, sample > m_pair; /// nav pair
+        boost::scoped_ptr< snark::applications::trajectory > m_trajectory; /// preloaded nav
+        bool m_out_of_order;
+        ::Eigen::Quaterniond m_second; /// second quaternion of nav pair on the same hemisphere as the first
+        double m_theta; /// angle between quaternions of nav pair
+        double m_sin_theta;
+        bool m_cached; /// true, if transform is valid for m_last
+        boost::posix_time::ptime m_last; /// timestamp of the last converted point
         point_type m_converted;
         bool m_discardOutOfOrder;
         bool m_discarded;
@@ -138,6 +196,9 @@ class frame
         bool rotation_present_;
 };
 
+/// replace each run of consecutive static frames with a single static frame of their combined transform
+std::vector< boost::shared_ptr< frame > > compose( const std::vector< boost::shared_ptr< frame > >& frames, bool rotation_present = false );
+
 } } // namespace snark{ namespace applications {
 
 #endif // SNARK_POINTS_FRAME_HEADER
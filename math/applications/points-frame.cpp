@@ -37,8 +37,12 @@
 #include <io.h>
 #endif
 
+#include <boost/bind.hpp>
 #include <boost/lexical_cast.hpp>
 #include <boost/optional.hpp>
+#include <tbb/atomic.h>
+#include <tbb/pipeline.h>
+#include <tbb/task_scheduler_init.h>
 #include <comma/application/command_line_options.h>
 #include <comma/application/signal_flag.h>
 #include <comma/csv/ascii.h>
@@ -70,6 +74,16 @@ static void usage()
     std::cerr << "    --output-frame : output each frame for each point" << std::endl;
     std::cerr << "                     can be individually specified for a frame, e.g.:" << std::endl;
     std::cerr << "                     --from \"novatel.csv;output-frame\"" << std::endl;
+    std::cerr << "    --parallel : read nav data into memory on start and convert batches of points" << std::endl;
+    std::cerr << "                 on all cores, preserving the order of output; not with --output-frame" << std::endl;
+    std::cerr << "    --batch-size <n> : number of points per batch for --parallel; default: 10000" << std::endl;
+    std::cerr << "    --out-of-order : points may come in any time order; nav data is read into memory" << std::endl;
+    std::cerr << "                     and looked up by time, nav file does not need to be sorted;" << std::endl;
+    std::cerr << "                     points outside of nav data are discarded (use --discard)" << std::endl;
+    std::cerr << "                     instead of ending the output" << std::endl;
+    std::cerr << std::endl;
+    std::cerr << "    consecutive frames given as <x>,<y>,<z>[,<roll>,<pitch>,<yaw>] are composed" << std::endl;
+    std::cerr << "    into a single transform" << std::endl;
     std::cerr << std::endl;
     std::cerr << "    IMPORTANT: <frame> is the transformation from reference frame to frame" << std::endl;
     std::cerr << std::endl;
@@ -159,6 +173,119 @@ std::vector< boost::shared_ptr< snark::applications::frame > > parseframes( cons
     return frames;
 }
 
+struct batch
+{
+    enum status { converted, discarded, end };
+    std::vector< snark::applications::frame::point_type > points;
+    std::vector< std::string > binary_records;
+    std::vector< std::vector< std::string > > ascii_records;
+    std::vector< status > statuses;
+};
+
+/// converts batches of points in a tbb pipeline: reading and writing are serial, conversion runs in parallel
+class parallel_conversion
+{
+    public:
+        typedef std::vector< boost::shared_ptr< snark::applications::frame > > frames_type;
+
+        parallel_conversion( const frames_type& frames, const comma::csv::options& csv, std::size_t batch_size );
+
+        void run();
+
+    private:
+        batch* read_( ::tbb::flow_control& flow );
+        batch* convert_( batch* b ) const;
+        void write_( batch* b );
+
+        frames_type m_frames;
+        comma::csv::options m_csv;
+        std::size_t m_batch_size;
+        comma::csv::input_stream< snark::applications::frame::point_type > m_istream;
+        comma::csv::output_stream< snark::applications::frame::point_type > m_ostream;
+        comma::signal_flag m_shutdown;
+        ::tbb::atomic< bool > m_done; /// set by write stage at the end of nav data, read by read stage
+        boost::posix_time::ptime m_latest; /// latest time of points read so far, to treat points going back in time as streaming conversion does
+};
+
+parallel_conversion::parallel_conversion( const frames_type& frames, const comma::csv::options& csv, std::size_t batch_size )
+    : m_frames( frames )
+    , m_csv( csv )
+    , m_batch_size( batch_size )
+    , m_istream( std::cin, csv )
+    , m_ostream( std::cout, csv )
+{
+    m_done = false;
+    if( !m_ostream.is_binary() ) { m_ostream.ascii().precision( 12 ); }
+    for( std::size_t i = 0; i < m_frames.size(); ++i ) { m_frames[i]->preload(); }
+}
+
+void parallel_conversion::run()
+{
+    ::tbb::filter_t< void, batch* > read_filter( ::tbb::filter::serial_in_order, boost::bind( &parallel_conversion::read_, this, _1 ) );
+    ::tbb::filter_t< batch*, batch* > convert_filter( ::tbb::filter::parallel, boost::bind( &parallel_conversion::convert_, this, _1 ) );
+    ::tbb::filter_t< batch*, void > write_filter( ::tbb::filter::serial_in_order, boost::bind( &parallel_conversion::write_, this, _1 ) );
+    ::tbb::task_scheduler_init init;
+    ::tbb::parallel_pipeline( init.default_num_threads() * 2, read_filter & convert_filter & write_filter );
+    std::cout.flush();
+}
+
+batch* parallel_conversion::read_( ::tbb::flow_control& flow )
+{
+    batch* b = new batch;
+    b->points.reserve( m_batch_size );
+    while( !m_done && !m_shutdown && b->points.size() < m_batch_size )
+    {
+        const snark::applications::frame::point_type* p = m_istream.read();
+        if( p == NULL ) { break; }
+        b->points.push_back( *p );
+        if( m_csv.binary() ) { b->binary_records.push_back( std::string( m_istream.binary().last(), m_csv.format().size() ) ); }
+        else { b->ascii_records.push_back( m_istream.ascii().last() ); }
+        batch::status status = batch::converted;
+        for( std::size_t i = 0; i < m_frames.size() && status == batch::converted; ++i ) { if( m_frames[i]->out_of_order( p->t, m_latest ) ) { status = batch::discarded; } }
+        if( status == batch::converted && ( m_latest.is_special() || p->t > m_latest ) ) { m_latest = p->t; }
+        b->statuses.push_back( status );
+    }
+    if( b->points.empty() ) { delete b; flow.stop(); return NULL; }
+    return b;
+}
+
+batch* parallel_conversion::convert_( batch* b ) const
+{
+    snark::applications::frame::point_type converted;
+    for( std::size_t i = 0; i < b->points.size(); ++i )
+    {
+        if( b->statuses[i] == batch::discarded ) { continue; }
+        for( std::size_t j = 0; j < m_frames.size(); ++j )
+        {
+            bool discarded;
+            const snark::applications::frame::point_type* c = m_frames[j]->converted( b->points[i], converted, discarded );
+            if( c == NULL ) { b->statuses[i] = discarded ? batch::discarded : batch::end; break; }
+            b->points[i] = converted;
+        }
+    }
+    return b;
+}
+
+void parallel_conversion::write_( batch* b )
+{
+    for( std::size_t i = 0; i < b->points.size() && !m_done; ++i )
+    {
+        switch( b->statuses[i] )
+        {
+            case batch::converted:
+                if( m_csv.binary() ) { m_ostream.write( b->points[i], b->binary_records[i] ); }
+                else { m_ostream.write( b->points[i], b->ascii_records[i] ); }
+                break;
+            case batch::discarded:
+                break;
+            case batch::end:
+                m_done = true;
+                break;
+        }
+    }
+    delete b;
+}
+
 void run( const std::vector< boost::shared_ptr< snark::applications::frame > >& frames, const comma::csv::options& csv )
 {
     comma::signal_flag shutdownFlag;
@@ -305,7 +432,19 @@ int main( int ac, char** av )
         //else { if( csv.fields != "" && !comma::csv::namesValid( comma::split( csv.fields, ',' ), comma::split( "x,y,z", ',' ) ) ) { COMMA_THROW( comma::exception, "expected mandatory fields x,y,z; got " << csv.fields ); } }
         if( timestampRequired ) { if( csv.fields != "" && !comma::csv::fields_exist( csv.fields, "t" ) ) { COMMA_THROW( comma::exception, "expected mandatory field t; got " << csv.fields ); } }
         csv.precision = 12;
-        run( frames, csv );
+        frames = snark::applications::compose( frames, rotation_present );
+        if( options.exists( "--out-of-order" ) ) { for( std::size_t i = 0; i < frames.size(); ++i ) { frames[i]->preload( true ); } }
+        if( options.exists( "--parallel" ) )
+        {
+            for( std::size_t i = 0; i < frames.size(); ++i ) { if( frames[i]->outputframe ) { COMMA_THROW( comma::exception, "--output-frame not supported with --parallel" ); } }
+            std::size_t batch_size = options.value( "--batch-size", 10000u );
+            if( batch_size == 0 ) { COMMA_THROW( comma::exception, "expected positive --batch-size" ); }
+            parallel_conversion( frames, csv, batch_size ).run();
+        }
+        else
+        {
+            run( frames, csv );
+        }
         return 0;
     }
     catch( std::exception& ex ) { std::cerr << "points-frame: " << ex.what() << std::endl; }
@@ -33,11 +33,15 @@
 
 /// @author vsevolod vlaskine
 
+#include <cstring>
+#include <vector>
+#include <comma/application/command_line_options.h>
 #include <comma/application/signal_flag.h>
 #include <comma/csv/stream.h>
 #include <comma/string/string.h>
 #include <snark/math/range_bearing_elevation.h>
 #include <snark/visiting/traits.h>
+#include "./polar.h"
 
 template< typename IStream, typename OStream >
 int run( IStream& is, OStream& os )
@@ -52,6 +56,39 @@ int run( IStream& is, OStream& os )
     return 0;
 }
 
+static int run_batch( const comma::csv::options& input_options, const comma::csv::options& output_options, std::size_t batch_size, snark::math::trigonometry::accuracy accuracy )
+{
+    comma::csv::binary_input_stream< snark::applications::polar > is( std::cin, input_options );
+    comma::csv::binary_output_stream< Eigen::Vector3d > os( std::cout, output_options );
+    const std::size_t record_size = input_options.format().size();
+    std::vector< char > records( batch_size * record_size );
+    std::vector< double > ranges( batch_size );
+    std::vector< double > bearings( batch_size );
+    std::vector< double > elevations( batch_size );
+    std::vector< double > x( batch_size );
+    std::vector< double > y( batch_size );
+    std::vector< double > z( batch_size );
+    comma::signal_flag is_shutdown;
+    bool done = false;
+    while( !done && !is_shutdown )
+    {
+        std::size_t size = 0;
+        for( ; size < batch_size; ++size )
+        {
+            const snark::applications::polar* p = is.read();
+            if( p == NULL ) { done = true; break; }
+            ranges[size] = p->range;
+            bearings[size] = p->bearing;
+            elevations[size] = p->elevation;
+            ::memcpy( &records[ size * record_size ], is.last(), record_size );
+        }
+        if( size == 0 ) { break; }
+        snark::to_cartesian( &ranges[0], &bearings[0], &elevations[0], &x[0], &y[0], &z[0], size, accuracy );
+        for( std::size_t i = 0; i < size; ++i ) { os.write( Eigen::Vector3d( x[i], y[i], z[i] ), &records[ i * record_size ] ); }
+    }
+    return 0;
+}
+
 static void usage()
 {
     std::cerr << std::endl;
@@ -63,9 +100,14 @@ static void usage()
     std::cerr << comma::csv::options::usage() << std::endl;
     std::cerr << "    fields: r or range, b or bearing, e or elevation, default: r,b,e" << std::endl;
     std::cerr << std::endl;
+    std::cerr << "binary input is converted in batches" << std::endl;
+    std::cerr << "    --batch-size=<n>: number of points per batch; default: 1024; use 1 for lowest latency" << std::endl;
+    std::cerr << "    --accuracy=<accuracy>: fast (error below 1e-6), accurate (within a few ulp), exact (std library); default: accurate" << std::endl;
+    std::cerr << std::endl;
     std::cerr << "examples" << std::endl;
     std::cerr << "    cat rbe.csv | points-to-cartesian --fields=r,b,e > xyz.csv" << std::endl;
     std::cerr << "    cat rbe.bin | points-to-cartesian --fields=r,b --binary=3d > xy0.bin" << std::endl;
+    std::cerr << "    cat rbe.bin | points-to-cartesian --binary=3d --accuracy=fast > xyz.bin" << std::endl;
     std::cerr << std::endl;
     exit( -1 );
 }
@@ -96,9 +138,10 @@ int main( int ac, char** av )
         output_options.fields = comma::join( output_fields, ',' );
         if( input_options.binary() )
         {
-            comma::csv::binary_input_stream< snark::range_bearing_elevation > is( std::cin, input_options );
-            comma::csv::binary_output_stream< Eigen::Vector3d > os( std::cout, output_options );
-            return run( is, os );
+            std::size_t batch_size = options.value( "--batch-size", 1024u );
+            if( batch_size == 0 ) { std::cerr << "points-to-cartesian: expected positive --batch-size" << std::endl; return 1; }
+            snark::math::trigonometry::accuracy accuracy = snark::math::trigonometry::accuracy_from_string( options.value< std::string >( "--accuracy", "accurate" ).c_str() );
+            return run_batch( input_options, output_options, batch_size, accuracy );
         }
         else
         {
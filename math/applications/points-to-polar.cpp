@@ -33,11 +33,48 @@
 
 /// @author vsevolod vlaskine
 
+#include <cstring>
+#include <vector>
+#include <comma/application/command_line_options.h>
 #include <comma/application/signal_flag.h>
 #include <comma/csv/stream.h>
 #include <comma/string/string.h>
 #include <snark/math/range_bearing_elevation.h>
 #include <snark/visiting/traits.h>
+#include "./polar.h"
+
+static int run_batch( const comma::csv::options& input_options, const comma::csv::options& output_options, std::size_t batch_size, snark::math::trigonometry::accuracy accuracy )
+{
+    comma::csv::binary_input_stream< Eigen::Vector3d > is( std::cin, input_options );
+    comma::csv::binary_output_stream< snark::applications::polar > os( std::cout, output_options );
+    const std::size_t record_size = input_options.format().size();
+    std::vector< char > records( batch_size * record_size );
+    std::vector< double > x( batch_size );
+    std::vector< double > y( batch_size );
+    std::vector< double > z( batch_size );
+    std::vector< double > ranges( batch_size );
+    std::vector< double > bearings( batch_size );
+    std::vector< double > elevations( batch_size );
+    comma::signal_flag is_shutdown;
+    bool done = false;
+    while( !done && !is_shutdown )
+    {
+        std::size_t size = 0;
+        for( ; size < batch_size; ++size )
+        {
+            const Eigen::Vector3d* p = is.read();
+            if( p == NULL ) { done = true; break; }
+            x[size] = p->x();
+            y[size] = p->y();
+            z[size] = p->z();
+            ::memcpy( &records[ size * record_size ], is.last(), record_size );
+        }
+        if( size == 0 ) { break; }
+        snark::from_cartesian( &x[0], &y[0], &z[0], &ranges[0], &bearings[0], &elevations[0], size, accuracy );
+        for( std::size_t i = 0; i < size; ++i ) { os.write( snark::applications::polar( ranges[i], bearings[i], elevations[i] ), &records[ i * record_size ] ); }
+    }
+    return 0;
+}
 
 static void usage()
 {
@@ -50,9 +87,14 @@ static void usage()
     std::cerr << comma::csv::options::usage() << std::endl;
     std::cerr << "    fields: r or range, b or bearing, e or elevation, default: r,b,e" << std::endl;
     std::cerr << std::endl;
+    std::cerr << "binary input is converted in batches" << std::endl;
+    std::cerr << "    --batch-size=<n>: number of points per batch; default: 1024; use 1 for lowest latency" << std::endl;
+    std::cerr << "    --accuracy=<accuracy>: fast (error below 1e-6), accurate (within a few ulp), exact (std library); default: accurate" << std::endl;
+    std::cerr << std::endl;
     std::cerr << "examples" << std::endl;
     std::cerr << "    cat xyz.csv | points-to-polar --fields=x,y,z > rbe.csv" << std::endl;
     std::cerr << "    cat xyz.bin | points-to-polar --fields=x,y --binary=3d > rb0.bin" << std::endl;
+    std::cerr << "    cat xyz.bin | points-to-polar --binary=3d --accuracy=fast > rbe.bin" << std::endl;
     std::cerr << std::endl;
     exit( -1 );
 }
@@ -78,6 +120,13 @@ int main( int ac, char** av )
         if( !fields_set ) { std::cerr << "points-to-polar: expected some of the fields: " << comma::join( comma::csv::names< Eigen::Vector3d >(), ',' ) << ", got none in: " << input_options.fields << std::endl; return 1; }
         input_options.fields = comma::join( fields, ',' );
         output_options.fields = comma::join( output_fields, ',' );
+        if( input_options.binary() )
+        {
+            std::size_t batch_size = options.value( "--batch-size", 1024u );
+            if( batch_size == 0 ) { std::cerr << "points-to-polar: expected positive --batch-size" << std::endl; return 1; }
+            snark::math::trigonometry::accuracy accuracy = snark::math::trigonometry::accuracy_from_string( options.value< std::string >( "--accuracy", "accurate" ).c_str() );
+            return run_batch( input_options, output_options, batch_size, accuracy );
+        }
         comma::csv::input_stream< Eigen::Vector3d > is( std::cin, input_options );
         comma::csv::output_stream< snark::range_bearing_elevation > os( std::cout, output_options );
         comma::signal_flag is_shutdown;
@@ -87,8 +136,7 @@ int main( int ac, char** av )
             if( p == NULL ) { return 0; }
             snark::range_bearing_elevation rbe;
             rbe.from_cartesian( *p );
-            if( input_options.binary() ) { os.write( rbe, is.binary().last() ); }
-            else { os.write( rbe, is.ascii().last() ); }
+            os.write( rbe, is.ascii().last() );
         }
         return 0;
     }
@@ -0,0 +1,75 @@
+// This file is part of snark, a generic and flexible library for robotics research
+// Copyright (c) 2011 The University of Sydney
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. All advertising materials mentioning features or use of this software
+//    must display the following acknowledgement:
+//    This product includes software developed by the The University of Sydney.
+// 4. Neither the name of the The University of Sydney nor the
+//    names of its contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+//
+// NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+// GRANTED BY THIS LICENSE.  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+// HOLDERS AND CONTRIBUTORS \"AS IS\" AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+// BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+// OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+// IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef SNARK_APPLICATIONS_POLAR_H_
+#define SNARK_APPLICATIONS_POLAR_H_
+
+#include <comma/visiting/traits.h>
+
+namespace snark{ namespace applications {
+
+/// range, bearing, elevation record of batch conversions in points-to-polar and points-to-cartesian;
+/// angles are not normalised on input, since batch conversion does not need it
+struct polar
+{
+    double range;
+    double bearing;
+    double elevation;
+    polar() : range( 0 ), bearing( 0 ), elevation( 0 ) {}
+    polar( double r, double b, double e ) : range( r ), bearing( b ), elevation( e ) {}
+};
+
+} } // namespace snark{ namespace applications {
+
+namespace comma { namespace visiting {
+
+template <> struct traits< snark::applications::polar >
+{
+    template < typename K, typename V > static void visit( const K&, snark::applications::polar& p, V& v )
+    {
+        v.apply( "range", p.range );
+        v.apply( "bearing", p.bearing );
+        v.apply( "elevation", p.elevation );
+    }
+
+    template < typename K, typename V > static void visit( const K&, const snark::applications::polar& p, V& v )
+    {
+        v.apply( "range", p.range );
+        v.apply( "bearing", p.bearing );
+        v.apply( "elevation", p.elevation );
+    }
+};
+
+} } // namespace comma { namespace visiting {
+
+#endif /*SNARK_APPLICATIONS_POLAR_H_*/
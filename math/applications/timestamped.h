@@ -35,6 +35,7 @@
 #define SNARK_APPLICATIONS_TIMESTAMPEDPOSITION_H_
 
 #include <snark/timing/time.h>
+#include <snark/timing/timestamp.h>
 #include <comma/visiting/traits.h>
 
 namespace snark{ namespace applications {
@@ -49,7 +50,7 @@ struct timestamped
 
 namespace detail {
 
-inline std::string toString( const boost::posix_time::ptime& t ) { return boost::posix_time::to_iso_string( t ); }
+inline std::string toString( const boost::posix_time::ptime& t ) { return timing::timestamp( t ).to_iso_string(); }
 
 } // namespace detail {
 
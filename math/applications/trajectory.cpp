@@ -0,0 +1,128 @@
+// This file is part of snark, a generic and flexible library for robotics research
+// Copyright (c) 2011 The University of Sydney
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. All advertising materials mentioning features or use of this software
+//    must display the following acknowledgement:
+//    This product includes software developed by the The University of Sydney.
+// 4. Neither the name of the The University of Sydney nor the
+//    names of its contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+//
+// NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+// GRANTED BY THIS LICENSE.  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+// HOLDERS AND CONTRIBUTORS \"AS IS\" AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+// BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+// OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+// IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <algorithm>
+#include <cmath>
+#include <Eigen/StdVector>
+#include <comma/base/exception.h>
+#include <snark/math/rotation_matrix.h>
+#include "./trajectory.h"
+
+namespace snark{ namespace applications {
+
+static bool earlier( const trajectory::node& lhs, const trajectory::node& rhs ) { return lhs.t < rhs.t; }
+
+static bool node_after( const boost::posix_time::ptime& t, const trajectory::node& n ) { return t < n.t; }
+
+void trajectory::push_back( const boost::posix_time::ptime& t, const ::Eigen::Vector3d& coordinates, const ::Eigen::Vector3d& orientation )
+{
+    node n;
+    n.t = t;
+    n.coordinates = coordinates;
+    n.quaternion = ::Eigen::Quaterniond::Identity(); // set from orientation on commit()
+    n.theta = n.sin_theta = 0;
+    m_nodes.push_back( n );
+    m_orientations.push_back( orientation );
+}
+
+void trajectory::commit()
+{
+    if( !m_orientations.empty() )
+    {
+        std::vector< ::Eigen::Quaterniond, ::Eigen::aligned_allocator< ::Eigen::Quaterniond > > quaternions( m_orientations.size() );
+        snark::rotation_matrix::quaternions( &m_orientations[0], &quaternions[0], m_orientations.size() );
+        std::size_t begin = m_nodes.size() - m_orientations.size();
+        for( std::size_t i = 0; i < quaternions.size(); ++i ) { m_nodes[ begin + i ].quaternion = quaternions[i]; }
+        m_orientations.clear();
+    }
+    std::stable_sort( m_nodes.begin(), m_nodes.end(), &earlier );
+    for( std::size_t i = 1; i < m_nodes.size(); ++i )
+    {
+        node& previous = m_nodes[ i - 1 ];
+        node& n = m_nodes[i];
+        double d = previous.quaternion.dot( n.quaternion );
+        if( d < 0 ) { n.quaternion.coeffs() = -n.quaternion.coeffs(); d = -d; }
+        previous.theta = std::acos( std::min( d, 1.0 ) );
+        previous.sin_theta = std::sin( previous.theta );
+    }
+}
+
+trajectory::status trajectory::pose( const boost::posix_time::ptime& t
+                                   , bool interpolate
+                                   , const boost::optional< boost::posix_time::time_duration >& max_gap
+                                   , ::Eigen::Vector3d& coordinates
+                                   , ::Eigen::Quaterniond& orientation ) const
+{
+    if( m_nodes.empty() ) { COMMA_THROW( comma::exception, "trajectory is empty" ); }
+    if( t < m_nodes.front().t ) { return before; }
+    if( t > m_nodes.back().t ) { return after; }
+    if( m_nodes.size() == 1 ) { coordinates = m_nodes[0].coordinates; orientation = m_nodes[0].quaternion; return found; }
+    const_iterator it = interval( t );
+    const node& first = *it;
+    const node& second = *( it + 1 );
+    if( max_gap && ( second.t - first.t ) > *max_gap ) { return gap; }
+    double factor = first.t == second.t ? 1 : double( ( t - first.t ).total_microseconds() ) / ( second.t - first.t ).total_microseconds();
+    if( !interpolate ) { factor = factor * 2 > 1 ? 1 : 0; } // nearest
+    coordinates = first.coordinates * ( 1 - factor ) + second.coordinates * factor;
+    orientation = slerp( first.quaternion, second.quaternion, first.theta, first.sin_theta, factor );
+    return found;
+}
+
+trajectory::const_iterator trajectory::interval( const boost::posix_time::ptime& t ) const
+{
+    if( m_nodes.empty() || t < m_nodes.front().t || t > m_nodes.back().t ) { return m_nodes.end(); }
+    if( m_nodes.size() == 1 ) { return m_nodes.begin(); }
+    const_iterator it = std::upper_bound( m_nodes.begin() + 1, m_nodes.end(), t, &node_after );
+    if( it == m_nodes.end() || ( t == ( it - 1 )->t && it - 1 != m_nodes.begin() ) ) { --it; } // on a sample, take interval ending at it
+    return it - 1;
+}
+
+::Eigen::Quaterniond trajectory::slerp( const ::Eigen::Quaterniond& first, const ::Eigen::Quaterniond& second, double theta, double sin_theta, double factor )
+{
+    // slerp with angle precomputed per nav interval; unlike linear interpolation of euler angles,
+    // it does not go the long way around when yaw wraps at +/-pi
+    static const double epsilon = 1e-9;
+    double a = 1 - factor;
+    double b = factor;
+    if( sin_theta > epsilon ) // otherwise, quaternions are so close that linear interpolation is exact enough
+    {
+        a = std::sin( a * theta ) / sin_theta;
+        b = std::sin( b * theta ) / sin_theta;
+    }
+    ::Eigen::Quaterniond q;
+    q.coeffs() = first.coeffs() * a + second.coeffs() * b;
+    q.normalize();
+    return q;
+}
+
+} } // namespace snark{ namespace applications {
@@ -0,0 +1,106 @@
+// This file is part of snark, a generic and flexible library for robotics research
+// Copyright (c) 2011 The University of Sydney
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. All advertising materials mentioning features or use of this software
+//    must display the following acknowledgement:
+//    This product includes software developed by the The University of Sydney.
+// 4. Neither the name of the The University of Sydney nor the
+//    names of its contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+//
+// NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+// GRANTED BY THIS LICENSE.  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+// HOLDERS AND CONTRIBUTORS \"AS IS\" AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+// BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+// OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+// IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef SNARK_APPLICATIONS_TRAJECTORY_H_
+#define SNARK_APPLICATIONS_TRAJECTORY_H_
+
+#include <vector>
+#include <boost/optional.hpp>
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+#include <Eigen/StdVector>
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+namespace snark{ namespace applications {
+
+/// nav trajectory in memory, indexed by time
+///
+/// samples can be added in any order; after commit(), pose at any time
+/// can be queried in any order and from several threads at once
+class trajectory
+{
+    public:
+        /// nav sample with interpolation parameters precomputed
+        struct node
+        {
+            boost::posix_time::ptime t;
+            ::Eigen::Vector3d coordinates;
+            ::Eigen::Quaterniond quaternion; /// on the same hemisphere as quaternion of previous node
+            double theta; /// angle between quaternions of this and next node
+            double sin_theta;
+
+            EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+        };
+
+        typedef std::vector< node, ::Eigen::aligned_allocator< node > > nodes_type;
+
+        typedef nodes_type::const_iterator const_iterator;
+
+        /// result of pose lookup
+        enum status { found, before, after, gap };
+
+        /// add nav sample
+        /// @param orientation roll, pitch, yaw
+        void push_back( const boost::posix_time::ptime& t, const ::Eigen::Vector3d& coordinates, const ::Eigen::Vector3d& orientation );
+
+        /// convert orientations of new samples in batch, sort samples by time and precompute interpolation parameters
+        /// call once all samples are added
+        void commit();
+
+        /// pose at given time, interpolated between neighbouring samples or taken from the nearest one
+        /// @param max_gap if given, times between samples further apart than max_gap have no pose
+        status pose( const boost::posix_time::ptime& t
+                   , bool interpolate
+                   , const boost::optional< boost::posix_time::time_duration >& max_gap
+                   , ::Eigen::Vector3d& coordinates
+                   , ::Eigen::Quaterniond& orientation ) const;
+
+        /// first sample of the interval that pose() takes for given time, or end(), if time is outside of trajectory
+        const_iterator interval( const boost::posix_time::ptime& t ) const;
+
+        const_iterator begin() const { return m_nodes.begin(); }
+        const_iterator end() const { return m_nodes.end(); }
+        std::size_t size() const { return m_nodes.size(); }
+        bool empty() const { return m_nodes.empty(); }
+
+        /// spherical linear interpolation, given angle between quaternions on the same hemisphere
+        static ::Eigen::Quaterniond slerp( const ::Eigen::Quaterniond& first, const ::Eigen::Quaterniond& second, double theta, double sin_theta, double factor );
+
+    private:
+        nodes_type m_nodes;
+        std::vector< ::Eigen::Vector3d > m_orientations; /// of nodes added since last commit, converted in one batch
+};
+
+} } // namespace snark{ namespace applications {
+
+#endif // SNARK_APPLICATIONS_TRAJECTORY_H_
@@ -39,7 +39,11 @@
 
 namespace snark{ 
 
-/// Cooley-Tukey in-place fft based on Danielson-Lanczos algorithm
+/// in-place radix-4 decimation-in-time fft (with one radix-2 stage, if size is
+/// an odd power of 2), computing X[k] = sum( x[n] * exp( -2 pi i k n / N ) )
+///
+/// data are interleaved real and imaginary parts; size is the number of
+/// complex values and must be a power of 2
 ///
 /// see: Cooley-Tukey algorithm from Numerical Recipes in C++
 ///
@@ -48,11 +52,11 @@ namespace snark{
 template < typename T, std::size_t N >
 void fft( boost::array< T, N >& data );
 
-/// Cooley-Tukey in-place fft based on Danielson-Lanczos algorithm
+/// in-place radix-4 fft, see above
 template < typename T >
 void fft( T* data, std::size_t size );
 
-/// Cooley-Tukey fft based on Danielson-Lanczos algorithm (convenience function)
+/// radix-4 fft (convenience function)
 template < typename T, std::size_t N >
 boost::array< T, N > fft( const boost::array< T, N >& data );
 
@@ -73,57 +77,88 @@ inline boost::array< T, N > fft( const boost::array< T, N >& data )
 template < typename T >
 inline void fft( T* data, std::size_t size )
 {
-    unsigned long n, mmax, m, j, istep, i;
-    double wtemp, wr, wpr, wpi, wi, theta;
-    double tempr, tempi;
- 
+    if( size < 2 ) { return; }
     // reverse-binary reindexing
-    n = size << 1;
-    j = 1;
-    for( i = 1; i < n; i += 2 )
+    for( std::size_t i = 0, j = 0; i < size; ++i )
     {
         if( j > i )
         {
-            std::swap( data[ j - 1 ], data[ i - 1 ] );
-            std::swap( data[j], data[i]);
+            T re = data[ 2 * j ];
+            T im = data[ 2 * j + 1 ];
+            data[ 2 * j ] = data[ 2 * i ];
+            data[ 2 * j + 1 ] = data[ 2 * i + 1 ];
+            data[ 2 * i ] = re;
+            data[ 2 * i + 1 ] = im;
         }
-        m = size;
-        while( m >= 2 && j > m )
+        std::size_t m = size >> 1;
+        for( ; m >= 1 && ( j & m ); m >>= 1 ) { j ^= m; }
+        j |= m;
+    }
+    std::size_t m = 1; // size of the transforms already done
+    std::size_t log2 = 0;
+    for( std::size_t s = size; s > 1; s >>= 1, ++log2 );
+    if( log2 & 1 ) // radix-2 stage
+    {
+        for( std::size_t i = 0; i < 2 * size; i += 4 )
         {
-            j -= m;
-            m >>= 1;
+            T re = data[ i + 2 ];
+            T im = data[ i + 3 ];
+            data[ i + 2 ] = data[i] - re;
+            data[ i + 3 ] = data[ i + 1 ] - im;
+            data[i] += re;
+            data[ i + 1 ] += im;
         }
-        j += m;
-    };
- 
-    // Danielson-Lanczos method
-    mmax = 2;
-    while( n > mmax )
+        m = 2;
+    }
+    for( ; m < size; m <<= 2 ) // radix-4 stages: combine sub-transforms of x[4n], x[4n+2], x[4n+1], x[4n+3] stored at offsets 0, m, 2m, 3m
     {
-        istep = mmax << 1;
-        theta = -( 2 * M_PI / mmax );
-        wtemp = std::sin( 0.5 * theta );
-        wpr = -2.0 * wtemp * wtemp;
-        wpi = std::sin( theta );
-        wr = 1.0;
-        wi = 0.0;
-        for( m = 1; m < mmax; m += 2 )
+        const double theta = -2 * M_PI / ( 4 * m );
+        const double wtemp = std::sin( 0.5 * theta );
+        const double wpr = -2.0 * wtemp * wtemp; // twiddle recurrence as in numerical recipes
+        const double wpi = std::sin( theta );
+        double wr = 1.0;
+        double wi = 0.0;
+        for( std::size_t k = 0; k < m; ++k )
         {
-            for( i = m; i <= n; i += istep )
+            const T w1r = wr;
+            const T w1i = wi;
+            const double w = wr;
+            wr += wr * wpr - wi * wpi;
+            wi += wi * wpr + w * wpi;
+            const T w2r = w1r * w1r - w1i * w1i;
+            const T w2i = 2 * w1r * w1i;
+            const T w3r = w2r * w1r - w2i * w1i;
+            const T w3i = w2r * w1i + w2i * w1r;
+            for( std::size_t j = k; j < size; j += 4 * m )
             {
-                j = i + mmax;
-                tempr = wr * data[j-1] - wi * data[j];
-                tempi = wr * data[j] + wi * data[j-1];
-                data[j-1] = data[i-1] - tempr;
-                data[j] = data[i] - tempi;
-                data[i-1] += tempr;
-                data[i] += tempi;
+                T* p0 = data + 2 * j;
+                T* p1 = p0 + 2 * m;
+                T* p2 = p1 + 2 * m;
+                T* p3 = p2 + 2 * m;
+                const T br = w2r * p1[0] - w2i * p1[1]; // x[4n+2] * w^2k
+                const T bi = w2r * p1[1] + w2i * p1[0];
+                const T cr = w1r * p2[0] - w1i * p2[1]; // x[4n+1] * w^k
+                const T ci = w1r * p2[1] + w1i * p2[0];
+                const T dr = w3r * p3[0] - w3i * p3[1]; // x[4n+3] * w^3k
+                const T di = w3r * p3[1] + w3i * p3[0];
+                const T t0r = p0[0] + br;
+                const T t0i = p0[1] + bi;
+                const T t1r = p0[0] - br;
+                const T t1i = p0[1] - bi;
+                const T t2r = cr + dr;
+                const T t2i = ci + di;
+                const T t3r = cr - dr;
+                const T t3i = ci - di;
+                p0[0] = t0r + t2r;
+                p0[1] = t0i + t2i;
+                p2[0] = t0r - t2r;
+                p2[1] = t0i - t2i;
+                p1[0] = t1r + t3i; // t1 - i * t3
+                p1[1] = t1i - t3r;
+                p3[0] = t1r - t3i; // t1 + i * t3
+                p3[1] = t1i + t3r;
             }
-            wtemp = wr;
-            wr += wr * wpr - wi * wpi;
-            wi += wi * wpr + wtemp * wpi;
         }
-        mmax = istep;
     }
 }
 
@@ -0,0 +1,260 @@
+// This file is part of snark, a generic and flexible library for robotics research
+// Copyright (c) 2011 The University of Sydney
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. All advertising materials mentioning features or use of this software
+//    must display the following acknowledgement:
+//    This product includes software developed by the The University of Sydney.
+// 4. Neither the name of the The University of Sydney nor the
+//    names of its contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+//
+// NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+// GRANTED BY THIS LICENSE.  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+// HOLDERS AND CONTRIBUTORS \"AS IS\" AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+// BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+// OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+// IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef SNARK_FILTER_BATCH_KALMAN_FILTER_H
+#define SNARK_FILTER_BATCH_KALMAN_FILTER_H
+
+#include <vector>
+#include <Eigen/Core>
+#include <Eigen/Cholesky>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <comma/base/exception.h>
+#include <snark/math/filter/kalman_state_traits.h>
+
+namespace snark{ 
+
+/// kalman filter for many tracks with the same motion model
+///
+/// states and covariances are stored as columns of two matrices
+/// (structure of arrays); prediction of all states is a single matrix
+/// product and covariance prediction, gating and updates run in parallel
+///
+/// the model is assumed to be linear with the jacobian and noise
+/// not depending on state, as constant_speed and constant_position are:
+/// update_state( s, dt ) is then the same as s = jacobian * s
+template< class State, class Model >
+class batch_kalman_filter
+{
+public:
+    enum { dimension = State::dimension };
+    typedef Eigen::Matrix< double, dimension, 1 > vector_type;
+    typedef Eigen::Matrix< double, dimension, dimension > covariance_type;
+
+    /// constructor
+    /// @param model motion model
+    batch_kalman_filter( Model& model ) : m_model( model ), m_size( 0 ) {}
+
+    /// add track, return its index
+    std::size_t add( const State& s );
+
+    /// remove track; the last track takes its index
+    void remove( std::size_t track );
+
+    /// number of tracks
+    std::size_t size() const { return m_size; }
+
+    /// get state of track
+    State state( std::size_t track ) const;
+
+    /// predict step for all tracks
+    /// @param deltaT time in seconds since last prediction
+    void predict( double deltaT );
+
+    /// update step for a single track
+    template< class Measurement >
+    void update( std::size_t track, const Measurement& m );
+
+    /// update tracks[i] with measurements[i] in parallel, tracks must be unique
+    template< class Measurement >
+    void update( const std::vector< std::size_t >& tracks, const std::vector< Measurement >& measurements );
+
+    /// return squared mahalanobis distance of measurement to track
+    template< class Measurement >
+    double gate( std::size_t track, const Measurement& m ) const;
+
+    /// fill distances( track, i ) with squared mahalanobis distances of measurements[i] to all tracks
+    /// e.g. compare against chi-square quantile for measurement dimension to associate measurements
+    template< class Measurement >
+    void gate( const std::vector< Measurement >& measurements, Eigen::MatrixXd& distances ) const;
+
+private:
+    typedef Eigen::Map< covariance_type > covariance_map;
+    typedef Eigen::Map< const covariance_type > const_covariance_map;
+
+    struct predictor;
+    template< class Measurement > struct updater;
+    template< class Measurement > struct gater;
+
+    Model& m_model; /// process model
+    Eigen::Matrix< double, dimension, Eigen::Dynamic > m_states; /// state vectors as columns
+    Eigen::Matrix< double, dimension * dimension, Eigen::Dynamic > m_covariances; /// covariances as columns
+    std::size_t m_size; /// number of tracks, columns beyond are spare capacity
+};
+
+template< class State, class Model >
+struct batch_kalman_filter< State, Model >::predictor
+{
+    const covariance_type& A;
+    const covariance_type& Q;
+    Eigen::Matrix< double, dimension * dimension, Eigen::Dynamic >& covariances;
+
+    predictor( const covariance_type& A, const covariance_type& Q, Eigen::Matrix< double, dimension * dimension, Eigen::Dynamic >& covariances ) : A( A ), Q( Q ), covariances( covariances ) {}
+
+    void operator()( const tbb::blocked_range< std::size_t >& range ) const
+    {
+        for( std::size_t i = range.begin(); i < range.end(); ++i )
+        {
+            covariance_map P( covariances.col( i ).data() );
+            P = A * P * A.transpose() + Q;
+        }
+    }
+};
+
+template< class State, class Model >
+template< class Measurement >
+struct batch_kalman_filter< State, Model >::updater
+{
+    batch_kalman_filter& filter;
+    const std::vector< std::size_t >& tracks;
+    const std::vector< Measurement >& measurements;
+
+    updater( batch_kalman_filter& filter, const std::vector< std::size_t >& tracks, const std::vector< Measurement >& measurements ) : filter( filter ), tracks( tracks ), measurements( measurements ) {}
+
+    void operator()( const tbb::blocked_range< std::size_t >& range ) const
+    {
+        for( std::size_t i = range.begin(); i < range.end(); ++i ) { filter.update( tracks[i], measurements[i] ); }
+    }
+};
+
+template< class State, class Model >
+template< class Measurement >
+struct batch_kalman_filter< State, Model >::gater
+{
+    const batch_kalman_filter& filter;
+    const std::vector< Measurement >& measurements;
+    Eigen::MatrixXd& distances;
+
+    gater( const batch_kalman_filter& filter, const std::vector< Measurement >& measurements, Eigen::MatrixXd& distances ) : filter( filter ), measurements( measurements ), distances( distances ) {}
+
+    void operator()( const tbb::blocked_range< std::size_t >& range ) const
+    {
+        for( std::size_t t = range.begin(); t < range.end(); ++t )
+        {
+            for( std::size_t i = 0; i < measurements.size(); ++i ) { distances( t, i ) = filter.gate( t, measurements[i] ); }
+        }
+    }
+};
+
+template< class State, class Model >
+inline std::size_t batch_kalman_filter< State, Model >::add( const State& s )
+{
+    if( m_size == std::size_t( m_states.cols() ) ) // grow geometrically to keep adding tracks amortised constant time
+    {
+        std::size_t capacity = m_size == 0 ? 16 : m_size * 2;
+        m_states.conservativeResize( Eigen::NoChange, capacity );
+        m_covariances.conservativeResize( Eigen::NoChange, capacity );
+    }
+    m_states.col( m_size ) = kalman_state_traits< State >::vector( s );
+    covariance_map( m_covariances.col( m_size ).data() ) = s.covariance;
+    return m_size++;
+}
+
+template< class State, class Model >
+inline void batch_kalman_filter< State, Model >::remove( std::size_t track )
+{
+    if( track >= m_size ) { COMMA_THROW( comma::exception, "expected track index less than " << m_size << ", got " << track ); }
+    --m_size;
+    if( track == m_size ) { return; }
+    m_states.col( track ) = m_states.col( m_size );
+    m_covariances.col( track ) = m_covariances.col( m_size );
+}
+
+template< class State, class Model >
+inline State batch_kalman_filter< State, Model >::state( std::size_t track ) const
+{
+    State s;
+    kalman_state_traits< State >::vector( s ) = m_states.col( track );
+    s.covariance = const_covariance_map( m_covariances.col( track ).data() );
+    return s;
+}
+
+template< class State, class Model >
+inline void batch_kalman_filter< State, Model >::predict( double deltaT )
+{
+    if( m_size == 0 ) { return; }
+    State s; // linear model: jacobian and noise do not depend on state
+    const covariance_type A = m_model.jacobian( s, deltaT );
+    const covariance_type Q = m_model.noise_covariance( deltaT );
+    m_states.leftCols( m_size ) = A * m_states.leftCols( m_size );
+    tbb::parallel_for( tbb::blocked_range< std::size_t >( 0, m_size, 64 ), predictor( A, Q, m_covariances ) );
+}
+
+template< class State, class Model >
+template< class Measurement >
+inline void batch_kalman_filter< State, Model >::update( std::size_t track, const Measurement& m )
+{
+    State s = state( track );
+    const Eigen::Matrix<double,Measurement::dimension,State::dimension>& H = m.measurement_jacobian( s );
+    const Eigen::Matrix<double,Measurement::dimension,Measurement::dimension>& R = m.measurement_covariance( s );
+    const Eigen::Matrix<double,Measurement::dimension,1>& innovation = m.innovation( s );
+
+    const Eigen::Matrix<double,State::dimension, Measurement::dimension> PHt = s.covariance * H.transpose();
+    const Eigen::LDLT< Eigen::Matrix<double,Measurement::dimension,Measurement::dimension> > S = ( H * PHt + R ).ldlt();
+
+    s.covariance -= PHt * S.solve( PHt.transpose() );
+    s.set_innovation( PHt * S.solve( innovation ) );
+    m_states.col( track ) = kalman_state_traits< State >::vector( s );
+    covariance_map( m_covariances.col( track ).data() ) = s.covariance;
+}
+
+template< class State, class Model >
+template< class Measurement >
+inline void batch_kalman_filter< State, Model >::update( const std::vector< std::size_t >& tracks, const std::vector< Measurement >& measurements )
+{
+    if( tracks.size() != measurements.size() ) { COMMA_THROW( comma::exception, "expected " << tracks.size() << " measurement(s), got " << measurements.size() ); }
+    tbb::parallel_for( tbb::blocked_range< std::size_t >( 0, tracks.size(), 16 ), updater< Measurement >( *this, tracks, measurements ) );
+}
+
+template< class State, class Model >
+template< class Measurement >
+inline double batch_kalman_filter< State, Model >::gate( std::size_t track, const Measurement& m ) const
+{
+    State s = state( track );
+    const Eigen::Matrix<double,Measurement::dimension,State::dimension>& H = m.measurement_jacobian( s );
+    const Eigen::Matrix<double,Measurement::dimension,1>& innovation = m.innovation( s );
+    const Eigen::Matrix<double,Measurement::dimension,Measurement::dimension> S = H * s.covariance * H.transpose() + m.measurement_covariance( s );
+    return innovation.dot( S.ldlt().solve( innovation ) );
+}
+
+template< class State, class Model >
+template< class Measurement >
+inline void batch_kalman_filter< State, Model >::gate( const std::vector< Measurement >& measurements, Eigen::MatrixXd& distances ) const
+{
+    distances.resize( m_size, measurements.size() );
+    tbb::parallel_for( tbb::blocked_range< std::size_t >( 0, m_size, 16 ), gater< Measurement >( *this, measurements, distances ) );
+}
+
+} 
+
+#endif // SNARK_FILTER_BATCH_KALMAN_FILTER_H
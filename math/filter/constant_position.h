@@ -35,6 +35,7 @@
 #define SNARK_FILTER_CONSTANT_POSITION_H
 
 #include <Eigen/Core>
+#include <snark/math/filter/kalman_state_traits.h>
 
 namespace snark{ 
 namespace constant_position {
@@ -86,11 +87,11 @@ struct model
 struct position
 {
     static const int dimension = 3;
-    Eigen::Vector3d position;
+    Eigen::Vector3d position_vector;
     Eigen::Matrix3d covariance;
     Eigen::Matrix3d jacobian;
 
-    position(): position( Eigen::Vector3d::Zero() ),
+    position(): position_vector( Eigen::Vector3d::Zero() ),
                 covariance( Eigen::Matrix3d::Identity() ),
                 jacobian( Eigen::Matrix3d::Identity() )
     {
@@ -108,11 +109,21 @@ struct position
 
     const Eigen::Matrix< double, dimension, 1 > innovation( const state & state ) const
     {
-        return position;
+        return position_vector - state.position;
     }
 };
 
+} // namespace constant_position
+
+/// state vector of constant position state is its position
+template<>
+struct kalman_state_traits< constant_position::state >
+{
+    typedef Eigen::Vector3d vector_type;
+    static vector_type& vector( constant_position::state& s ) { return s.position; }
+    static const vector_type& vector( const constant_position::state& s ) { return s.position; }
+};
 
-} } }
+}
 
 #endif // SNARK_FILTER_CONSTANT_POSITION_H
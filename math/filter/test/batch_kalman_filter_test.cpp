@@ -0,0 +1,144 @@
+// This file is part of snark, a generic and flexible library for robotics research
+// Copyright (c) 2011 The University of Sydney
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. All advertising materials mentioning features or use of this software
+//    must display the following acknowledgement:
+//    This product includes software developed by the The University of Sydney.
+// 4. Neither the name of the The University of Sydney nor the
+//    names of its contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+//
+// NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+// GRANTED BY THIS LICENSE.  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+// HOLDERS AND CONTRIBUTORS \"AS IS\" AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+// BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+// OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+// IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <gtest/gtest.h>
+#include <Eigen/Dense>
+#include <snark/math/filter/batch_kalman_filter.h>
+#include <snark/math/filter/constant_position.h>
+#include <snark/math/filter/constant_speed.h>
+#include <snark/math/filter/kalman_filter.h>
+
+namespace snark{
+
+namespace test
+{
+
+typedef constant_speed< 2 > model_type;
+
+static model_type::state make_state( double x, double y )
+{
+    model_type::state_type v;
+    v << x, y, 0, 0;
+    model_type::state s( v );
+    s.covariance = model_type::covariance_type::Identity();
+    return s;
+}
+
+// batch filter should give exactly the same result as individual filters
+TEST( batch_kalman_filter, same_as_kalman_filter )
+{
+    const std::size_t size = 200;
+    model_type::model model( 0.2 );
+    model_type::model batch_model( 0.2 );
+    std::vector< kalman_filter< model_type::state, model_type::model > > filters;
+    batch_kalman_filter< model_type::state, model_type::model > batch( batch_model );
+    for( std::size_t i = 0; i < size; ++i )
+    {
+        filters.push_back( kalman_filter< model_type::state, model_type::model >( make_state( i, -double( i ) ), model ) );
+        EXPECT_EQ( i, batch.add( make_state( i, -double( i ) ) ) );
+    }
+    EXPECT_EQ( size, batch.size() );
+    for( unsigned int step = 1; step < 10; ++step )
+    {
+        std::vector< std::size_t > tracks;
+        std::vector< model_type::position > measurements;
+        for( std::size_t i = 0; i < size; ++i )
+        {
+            filters[i].predict( 0.1 );
+            if( ( i + step ) % 3 == 0 ) { continue; } // not every track gets a measurement
+            model_type::position m( Eigen::Vector2d( i + 0.1 * step, 0.2 * step - i ), 0.3 );
+            filters[i].update( m );
+            tracks.push_back( i );
+            measurements.push_back( m );
+        }
+        batch.predict( 0.1 );
+        batch.update( tracks, measurements );
+        for( std::size_t i = 0; i < size; ++i )
+        {
+            EXPECT_TRUE( batch.state( i ).state_vector.isApprox( filters[i].state().state_vector, 1e-12 ) );
+            EXPECT_TRUE( batch.state( i ).covariance.isApprox( filters[i].state().covariance, 1e-12 ) );
+        }
+    }
+}
+
+TEST( batch_kalman_filter, gate )
+{
+    model_type::model model( 0.2 );
+    batch_kalman_filter< model_type::state, model_type::model > batch( model );
+    batch.add( make_state( 0, 0 ) );
+    batch.add( make_state( 10, 0 ) );
+    batch.add( make_state( 0, 10 ) );
+    std::vector< model_type::position > measurements;
+    measurements.push_back( model_type::position( Eigen::Vector2d( 0.1, 10.2 ), 0.3 ) );
+    measurements.push_back( model_type::position( Eigen::Vector2d( 0.1, -0.1 ), 0.3 ) );
+    Eigen::MatrixXd distances;
+    batch.gate( measurements, distances );
+    ASSERT_EQ( 3, distances.rows() );
+    ASSERT_EQ( 2, distances.cols() );
+    Eigen::MatrixXd::Index track;
+    distances.col( 0 ).minCoeff( &track );
+    EXPECT_EQ( 2, track );
+    distances.col( 1 ).minCoeff( &track );
+    EXPECT_EQ( 0, track );
+    EXPECT_DOUBLE_EQ( batch.gate( 1, measurements[0] ), distances( 1, 0 ) );
+    // innovation ( 0.1, -0.1 ), innovation covariance 1.3 * I
+    EXPECT_NEAR( 0.02 / 1.3, distances( 0, 1 ), 1e-12 );
+}
+
+TEST( batch_kalman_filter, remove )
+{
+    model_type::model model( 0.2 );
+    batch_kalman_filter< model_type::state, model_type::model > batch( model );
+    for( unsigned int i = 0; i < 40; ++i ) { batch.add( make_state( i, 0 ) ); }
+    batch.remove( 5 );
+    EXPECT_EQ( 39u, batch.size() );
+    EXPECT_DOUBLE_EQ( 39, batch.state( 5 ).state_vector[0] );
+    batch.remove( 38 );
+    EXPECT_EQ( 38u, batch.size() );
+    EXPECT_DOUBLE_EQ( 37, batch.state( 37 ).state_vector[0] );
+    EXPECT_THROW( batch.remove( 38 ), comma::exception );
+}
+
+TEST( batch_kalman_filter, constant_position )
+{
+    constant_position::model model;
+    batch_kalman_filter< constant_position::state, constant_position::model > batch( model );
+    constant_position::state s;
+    s.position = Eigen::Vector3d( 1, 2, 3 );
+    batch.add( s );
+    batch.predict( 0.5 );
+    EXPECT_TRUE( batch.state( 0 ).position.isApprox( Eigen::Vector3d( 1, 2, 3 ) ) );
+    EXPECT_TRUE( batch.state( 0 ).covariance.isApprox( Eigen::Matrix3d::Identity() * 1.5 ) );
+}
+
+} }
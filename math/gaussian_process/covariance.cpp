@@ -49,8 +49,22 @@ squared_exponential_covariance::squared_exponential_covariance( double length_sc
 
 double squared_exponential_covariance::covariance( const Eigen::VectorXd& v, const Eigen::VectorXd& w ) const
 {
-    const Eigen::VectorXd& diff = v - w;
-    return signal_variance_ * std::exp( factor_ * diff.dot( diff ) );
+    return signal_variance_ * std::exp( factor_ * ( v - w ).squaredNorm() );
+}
+
+void squared_exponential_covariance::block( const Eigen::MatrixXd& lhs, const Eigen::MatrixXd& rhs, Eigen::MatrixXd& covariances ) const
+{
+    if( lhs.rows() == 0 || rhs.rows() == 0 ) { covariances.resize( lhs.rows(), rhs.rows() ); return; }
+    // |v - w|^2 = |v|^2 + |w|^2 - 2 v.w, relative to a common origin: at e.g. utm coordinates
+    // the norms would be so large that their difference would lose all precision
+    const Eigen::RowVectorXd origin = lhs.row( 0 );
+    const Eigen::MatrixXd v = lhs.rowwise() - origin;
+    const Eigen::MatrixXd w = rhs.rowwise() - origin;
+    covariances.noalias() = v * w.transpose();
+    covariances *= -2;
+    covariances.colwise() += v.rowwise().squaredNorm();
+    covariances.rowwise() += w.rowwise().squaredNorm().transpose();
+    covariances = ( covariances.array().max( 0 ) * factor_ ).exp() * signal_variance_; // rounding may still give tiny negative distances
 }
 
 double squared_exponential_covariance::self_covariance() const { return self_covariance_; }
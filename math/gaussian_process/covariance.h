@@ -46,6 +46,11 @@ class squared_exponential_covariance
                                       , double data_variance );
 
         double covariance( const Eigen::VectorXd& v, const Eigen::VectorXd& w ) const;
+
+        /// fill covariances( i, j ) with covariance of lhs.row( i ) and rhs.row( j )
+        /// using pairwise squared distances from a single matrix product;
+        /// thread-safe, as gaussian_process calls it concurrently
+        void block( const Eigen::MatrixXd& lhs, const Eigen::MatrixXd& rhs, Eigen::MatrixXd& covariances ) const;
         
         double self_covariance() const;
 
@@ -31,39 +31,178 @@
 // IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 
+#include <cmath>
+#include <boost/bind.hpp>
 #include <boost/noncopyable.hpp>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
 #include <comma/base/exception.h>
 #include <snark/math/gaussian_process/gaussian_process.h>
 
 namespace snark{ 
 
+static const std::size_t block_rows = 64; // rows of covariance matrix per task
+
+static void pairwise_( const gaussian_process::covariance& covariance, const Eigen::MatrixXd& lhs, const Eigen::MatrixXd& rhs, Eigen::MatrixXd& covariances )
+{
+    covariances.resize( lhs.rows(), rhs.rows() );
+    for( std::size_t r = 0; r < std::size_t( lhs.rows() ); ++r )
+    {
+        const Eigen::VectorXd& row = lhs.row( r );
+        for( std::size_t c = 0; c < std::size_t( rhs.rows() ); ++c ) { covariances( r, c ) = covariance( row, rhs.row( c ) ); }
+    }
+}
+
+static void symmetric_( const gaussian_process::covariance& covariance, const Eigen::MatrixXd& domains, Eigen::MatrixXd& covariances ) // upper triangle only; diagonal is set by caller
+{
+    covariances.resize( domains.rows(), domains.rows() );
+    for( std::size_t r = 0; r < std::size_t( domains.rows() ); ++r )
+    {
+        const Eigen::VectorXd& row = domains.row( r );
+        for( std::size_t c = r + 1; c < std::size_t( domains.rows() ); ++c ) { covariances( c, r ) = covariances( r, c ) = covariance( row, domains.row( c ) ); }
+    }
+}
+
+struct block_filler
+{
+    const gaussian_process::block_covariance::function_type& covariance;
+    const Eigen::MatrixXd& lhs;
+    const Eigen::MatrixXd& rhs;
+    Eigen::MatrixXd& covariances;
+
+    block_filler( const gaussian_process::block_covariance::function_type& covariance, const Eigen::MatrixXd& lhs, const Eigen::MatrixXd& rhs, Eigen::MatrixXd& covariances )
+        : covariance( covariance ), lhs( lhs ), rhs( rhs ), covariances( covariances ) {}
+
+    void operator()( const tbb::blocked_range< std::size_t >& range ) const
+    {
+        Eigen::MatrixXd block;
+        covariance( lhs.middleRows( range.begin(), range.size() ), rhs, block );
+        covariances.middleRows( range.begin(), range.size() ) = block;
+    }
+};
+
 gaussian_process::gaussian_process( const Eigen::MatrixXd& domains
                                 , const Eigen::VectorXd& targets
                                 , const gaussian_process::covariance& covariance
                                 , double self_covariance )
     : domains_( domains )
     , targets_( targets )
-    , covariance_( covariance )
+    , pairwise_covariance_( covariance )
     , self_covariance_( self_covariance )
     , offset_( targets.sum() / targets.rows() )
-    , K_( domains.rows(), domains.rows() )
 {
-    if( domains.rows() != targets.rows() ) { COMMA_THROW( comma::exception, "expected " << domains.rows() << " row(s) in targets, got " << targets.rows() << " row(s)" ); }
+    init_();
+}
+
+gaussian_process::gaussian_process( const Eigen::MatrixXd& domains
+                                , const Eigen::VectorXd& targets
+                                , const gaussian_process::block_covariance& covariance
+                                , double self_covariance )
+    : domains_( domains )
+    , targets_( targets )
+    , covariance_( covariance.function )
+    , self_covariance_( self_covariance )
+    , offset_( targets.sum() / targets.rows() )
+{
+    init_();
+}
+
+void gaussian_process::init_()
+{
+    if( domains_.rows() != targets_.rows() ) { COMMA_THROW( comma::exception, "expected " << domains_.rows() << " row(s) in targets, got " << targets_.rows() << " row(s)" ); }
     targets_.array() -= offset_; // normalise
-    //use m_K as Kxx + variance*I, then invert it
-    //fill Kxx with values from covariance function
-    //for elements r,c in upper triangle
-    for( std::size_t r = 0; r < std::size_t( domains.rows() ); ++r )
+    Eigen::MatrixXd K; // Kxx + variance * I
+    covariances_( domains_, domains_, K );
+    K.diagonal().setConstant( self_covariance_ );
+    L_ = K.llt().matrixL();
+    solve_();
+}
+
+void gaussian_process::solve_() // alpha = ( L * L^T )^-1 * targets
+{
+    alpha_ = L_.triangularView< Eigen::Lower >().solve( targets_ );
+    L_.triangularView< Eigen::Lower >().transpose().solveInPlace( alpha_ );
+}
+
+std::size_t gaussian_process::size() const { return targets_.rows(); }
+
+void gaussian_process::insert( const Eigen::MatrixXd& domains, const Eigen::VectorXd& targets )
+{
+    if( domains.cols() != domains_.cols() ) { COMMA_THROW( comma::exception, "expected " << domains_.cols() << " column(s) in domains, got " << domains.cols() ); }
+    if( domains.rows() != targets.rows() ) { COMMA_THROW( comma::exception, "expected " << domains.rows() << " row(s) in targets, got " << targets.rows() << " row(s)" ); }
+    std::size_t n = size();
+    std::size_t m = domains.rows();
+    if( m == 0 ) { return; }
+    // [ L 0; B^T C ] with B = L^-1 * Kxx', C * C^T = Kx'x' - B^T * B
+    Eigen::MatrixXd B;
+    covariances_( domains_, domains, B );
+    L_.triangularView< Eigen::Lower >().solveInPlace( B );
+    Eigen::MatrixXd C;
+    covariances_( domains, domains, C );
+    C.diagonal().setConstant( self_covariance_ );
+    C.noalias() -= B.transpose() * B;
+    L_.conservativeResize( n + m, n + m );
+    L_.topRightCorner( n, m ).setZero();
+    L_.bottomLeftCorner( m, n ) = B.transpose();
+    L_.bottomRightCorner( m, m ) = C.llt().matrixL();
+    domains_.conservativeResize( n + m, domains_.cols() );
+    domains_.bottomRows( m ) = domains;
+    Eigen::VectorXd all( n + m );
+    all.head( n ) = targets_.array() + offset_;
+    all.tail( m ) = targets;
+    offset_ = all.sum() / all.rows();
+    targets_ = all.array() - offset_;
+    solve_();
+}
+
+void gaussian_process::remove( std::size_t index )
+{
+    std::size_t n = size();
+    if( index >= n ) { COMMA_THROW( comma::exception, "expected index less than " << n << ", got " << index ); }
+    if( n == 1 ) { COMMA_THROW( comma::exception, "cannot remove the only observation" ); }
+    std::size_t m = n - index - 1;
+    // [ L11 0 0; l21 l22 0; L31 l32 L33 ] becomes [ L11 0; L31 L33' ] with L33' * L33'^T = L33 * L33^T + l32 * l32^T
+    Eigen::MatrixXd L( n - 1, n - 1 );
+    L.topLeftCorner( index, index ) = L_.topLeftCorner( index, index );
+    L.topRightCorner( index, m ).setZero();
+    L.bottomLeftCorner( m, index ) = L_.bottomLeftCorner( m, index );
+    L.bottomRightCorner( m, m ) = L_.bottomRightCorner( m, m );
+    Eigen::VectorXd x = L_.col( index ).tail( m );
+    for( std::size_t k = 0; k < m; ++k ) // rank-one update of L33
     {
-        K_( r, r ) = self_covariance_;
-        const Eigen::VectorXd& row = domains.row( r );
-        for( std::size_t c = r + 1; c < std::size_t( domains.rows() ); ++c )
-        {
-            K_( c, r ) = K_( r, c ) = covariance_( row, domains.row( c ) );
-        }
+        std::size_t i = index + k;
+        double l = L( i, i );
+        double r = std::sqrt( l * l + x( k ) * x( k ) );
+        double c = r / l;
+        double s = x( k ) / l;
+        L( i, i ) = r;
+        std::size_t tail = m - k - 1;
+        if( tail == 0 ) { break; }
+        L.col( i ).tail( tail ) = ( L.col( i ).tail( tail ) + s * x.tail( tail ) ) / c;
+        x.tail( tail ) = c * x.tail( tail ) - s * L.col( i ).tail( tail );
     }
-    L_.compute( K_ ); // invert Kxx + variance * I to become (by definition) B
-    alpha_ = L_.solve( targets_ );
+    L_.swap( L );
+    Eigen::MatrixXd domains( n - 1, domains_.cols() );
+    domains.topRows( index ) = domains_.topRows( index );
+    domains.bottomRows( m ) = domains_.bottomRows( m );
+    domains_.swap( domains );
+    Eigen::VectorXd targets( n - 1 );
+    targets.head( index ) = targets_.head( index ).array() + offset_;
+    targets.tail( m ) = targets_.tail( m ).array() + offset_;
+    offset_ = targets.sum() / targets.rows();
+    targets_ = targets.array() - offset_;
+    solve_();
+}
+
+void gaussian_process::covariances_( const Eigen::MatrixXd& lhs, const Eigen::MatrixXd& rhs, Eigen::MatrixXd& covariances ) const
+{
+    if( pairwise_covariance_ ) // user functor, not necessarily thread-safe
+    {
+        if( &lhs == &rhs ) { symmetric_( pairwise_covariance_, lhs, covariances ); } else { pairwise_( pairwise_covariance_, lhs, rhs, covariances ); }
+        return;
+    }
+    covariances.resize( lhs.rows(), rhs.rows() );
+    tbb::parallel_for( tbb::blocked_range< std::size_t >( 0, lhs.rows(), block_rows ), block_filler( covariance_, lhs, rhs, covariances ) );
 }
 
 std::pair< double, double > gaussian_process::evaluate( const Eigen::MatrixXd& domain ) const
@@ -78,19 +217,12 @@ std::pair< double, double > gaussian_process::evaluate( const Eigen::MatrixXd& d
 void gaussian_process::evaluate( const Eigen::MatrixXd& domains, Eigen::VectorXd& means, Eigen::VectorXd& variances ) const
 {
     if( domains.cols() != domains_.cols() ) { COMMA_THROW( comma::exception, "expected " << domains_.cols() << " column(s) in domains, got " << domains.cols() << std::endl ); }
-    Eigen::MatrixXd Kxsx = Eigen::MatrixXd::Zero( domains.rows(), domains_.rows() );
-    for( std::size_t r = 0; r < std::size_t( domains.rows() ); ++r )
-    {
-        const Eigen::VectorXd& row = domains.row( r );
-        for( std::size_t c = 0; c < std::size_t( domains_.rows() ); ++c )
-        {
-            Kxsx( r, c ) = covariance_( row, domains_.row( c ) );
-        }
-    }
+    Eigen::MatrixXd Kxsx;
+    covariances_( domains, domains_, Kxsx );
     means = Kxsx * alpha_;
     means.array() += offset_;
     Eigen::MatrixXd Kxxs = Kxsx.transpose();
-    L_.matrixL().solveInPlace( Kxxs );
+    L_.triangularView< Eigen::Lower >().solveInPlace( Kxxs );
     Eigen::MatrixXd& variance = Kxxs;
     variance = variance.array() * variance.array();
     variances = variance.colwise().sum();
@@ -47,12 +47,30 @@ class gaussian_process
         /// covariance functor type
         typedef boost::function< double ( const Eigen::VectorXd&, const Eigen::VectorXd& ) > covariance;
 
-        /// constructor
+        /// block covariance functor: fills covariances( i, j ) for lhs.row( i ) and rhs.row( j ),
+        /// e.g. boost::bind( &squared_exponential_covariance::block, boost::ref( c ), _1, _2, _3 )
+        /// @note called concurrently for different blocks of rows, thus has to be thread-safe
+        struct block_covariance
+        {
+            typedef boost::function< void ( const Eigen::MatrixXd&, const Eigen::MatrixXd&, Eigen::MatrixXd& ) > function_type;
+
+            template < typename F > explicit block_covariance( F f ) : function( f ) {}
+
+            function_type function;
+        };
+
+        /// constructor; covariance is called serially, for symmetric matrices only on the upper triangle
         gaussian_process( const Eigen::MatrixXd& domains
                        , const Eigen::VectorXd& targets
                        , const gaussian_process::covariance& covariance
                        , double self_covariance = 0 );
 
+        /// constructor, covariance matrices are assembled in blocks of rows in parallel
+        gaussian_process( const Eigen::MatrixXd& domains
+                       , const Eigen::VectorXd& targets
+                       , const gaussian_process::block_covariance& covariance
+                       , double self_covariance = 0 );
+
         /// evaluate
         void evaluate( const Eigen::MatrixXd& domains
                      , Eigen::VectorXd& means
@@ -61,14 +79,28 @@ class gaussian_process
         /// evaluate a single domain, return mean-variance pair
         std::pair< double, double > evaluate( const Eigen::MatrixXd& domain ) const;
 
+        /// add observations, extending cholesky factor in O( n^2 ) instead of refactorising
+        void insert( const Eigen::MatrixXd& domains, const Eigen::VectorXd& targets );
+
+        /// remove observation with given index by rank-one update of cholesky factor in O( n^2 ),
+        /// e.g. remove( 0 ) to drop the oldest observation of a sliding window
+        void remove( std::size_t index );
+
+        /// number of observations
+        std::size_t size() const;
+
     private:
+        void init_();
+        void covariances_( const Eigen::MatrixXd& lhs, const Eigen::MatrixXd& rhs, Eigen::MatrixXd& covariances ) const;
+        void solve_();
+
         Eigen::MatrixXd domains_; //!< domain locations corresponding to targets
         Eigen::VectorXd targets_; //!< targets
-        covariance covariance_;
+        gaussian_process::covariance pairwise_covariance_;
+        block_covariance::function_type covariance_;
         double self_covariance_;
         double offset_;
-        Eigen::MatrixXd K_; //!< the inverse of (Kxx + noiseVariance*I)
-        Eigen::LLT< Eigen::MatrixXd  > L_; //!< cholesky factorization of the covariance Kxx
+        Eigen::MatrixXd L_; //!< lower triangular cholesky factor of Kxx + noiseVariance*I
         Eigen::VectorXd alpha_;
 };
 
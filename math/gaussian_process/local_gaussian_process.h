@@ -0,0 +1,241 @@
+// This file is part of snark, a generic and flexible library for robotics research
+// Copyright (c) 2011 The University of Sydney
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. All advertising materials mentioning features or use of this software
+//    must display the following acknowledgement:
+//    This product includes software developed by the The University of Sydney.
+// 4. Neither the name of the The University of Sydney nor the
+//    names of its contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+//
+// NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+// GRANTED BY THIS LICENSE.  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+// HOLDERS AND CONTRIBUTORS \"AS IS\" AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+// BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+// OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+// IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef SNARK_GAUSSIAN_PROCESS_LOCAL_
+#define SNARK_GAUSSIAN_PROCESS_LOCAL_
+
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <Eigen/Core>
+#include <comma/base/exception.h>
+#include <snark/math/gaussian_process/gaussian_process.h>
+#include <snark/point_cloud/voxel_map.h>
+
+namespace snark{ 
+
+/// local gaussian process approximation for large datasets
+///
+/// the domain space is partitioned into tiles of a given resolution;
+/// for each tile that has training points in it or in its immediate
+/// neighbours an exact gaussian_process is fitted to the points of the tile
+/// and its neighbours (optionally subsampled to at most max_points), so that
+/// memory and query cost are bounded by the tile density rather than by the
+/// total number of points
+///
+/// queries falling into a tile without training points in its neighbourhood
+/// get the prior: mean of all targets and self covariance as variance
+template < unsigned int D >
+class local_gaussian_process
+{
+    public:
+        /// number of dimensions of domain
+        enum { dimensions = D };
+
+        /// point type
+        typedef Eigen::Matrix< double, D, 1 > point_type;
+
+        /// constructor
+        /// @param resolution tile size
+        /// @param max_points maximum number of training points per local process, 0: unlimited
+        local_gaussian_process( const Eigen::MatrixXd& domains
+                              , const Eigen::VectorXd& targets
+                              , const point_type& resolution
+                              , const gaussian_process::block_covariance& covariance
+                              , double self_covariance = 0
+                              , std::size_t max_points = 0 );
+
+        /// evaluate, same semantics as gaussian_process::evaluate()
+        void evaluate( const Eigen::MatrixXd& domains
+                     , Eigen::VectorXd& means
+                     , Eigen::VectorXd& variances ) const;
+
+        /// evaluate a single domain, return mean-variance pair
+        std::pair< double, double > evaluate( const Eigen::MatrixXd& domain ) const;
+
+        /// number of local processes
+        std::size_t size() const { return processes_.size(); }
+
+    private:
+        typedef voxel_map< std::vector< std::size_t >, D > tiles_type;
+        typedef voxel_map< boost::shared_ptr< gaussian_process >, D > processes_type;
+        typedef typename tiles_type::index_type index_type;
+
+        struct builder;
+
+        std::vector< std::size_t > neighbourhood_( const tiles_type& tiles, const index_type& index ) const;
+        static unsigned int neighbours_();
+        static index_type neighbour_( const index_type& index, unsigned int n );
+
+        processes_type processes_;
+        gaussian_process::block_covariance covariance_;
+        double self_covariance_;
+        std::size_t max_points_;
+        double offset_;
+};
+
+template < unsigned int D >
+struct local_gaussian_process< D >::builder
+{
+    const local_gaussian_process& process;
+    const tiles_type& tiles;
+    const std::vector< index_type >& indices;
+    const Eigen::MatrixXd& domains;
+    const Eigen::VectorXd& targets;
+    std::vector< boost::shared_ptr< gaussian_process > >& processes;
+
+    builder( const local_gaussian_process& process
+           , const tiles_type& tiles
+           , const std::vector< index_type >& indices
+           , const Eigen::MatrixXd& domains
+           , const Eigen::VectorXd& targets
+           , std::vector< boost::shared_ptr< gaussian_process > >& processes )
+        : process( process ), tiles( tiles ), indices( indices ), domains( domains ), targets( targets ), processes( processes ) {}
+
+    void operator()( const tbb::blocked_range< std::size_t >& range ) const
+    {
+        for( std::size_t i = range.begin(); i < range.end(); ++i )
+        {
+            const std::vector< std::size_t >& rows = process.neighbourhood_( tiles, indices[i] );
+            Eigen::MatrixXd local_domains( rows.size(), domains.cols() );
+            Eigen::VectorXd local_targets( rows.size() );
+            for( std::size_t r = 0; r < rows.size(); ++r )
+            {
+                local_domains.row( r ) = domains.row( rows[r] );
+                local_targets( r ) = targets( rows[r] );
+            }
+            processes[i].reset( new gaussian_process( local_domains, local_targets, process.covariance_, process.self_covariance_ ) );
+        }
+    }
+};
+
+template < unsigned int D >
+inline local_gaussian_process< D >::local_gaussian_process( const Eigen::MatrixXd& domains
+                                                          , const Eigen::VectorXd& targets
+                                                          , const point_type& resolution
+                                                          , const gaussian_process::block_covariance& covariance
+                                                          , double self_covariance
+                                                          , std::size_t max_points )
+    : processes_( resolution )
+    , covariance_( covariance )
+    , self_covariance_( self_covariance )
+    , max_points_( max_points )
+    , offset_( targets.sum() / targets.rows() )
+{
+    if( domains.cols() != D ) { COMMA_THROW( comma::exception, "expected " << D << " column(s) in domains, got " << domains.cols() ); }
+    if( domains.rows() != targets.rows() ) { COMMA_THROW( comma::exception, "expected " << domains.rows() << " row(s) in targets, got " << targets.rows() << " row(s)" ); }
+    tiles_type tiles( resolution );
+    for( std::size_t i = 0; i < std::size_t( domains.rows() ); ++i ) { tiles.touch_at( domains.row( i ).transpose() )->second.push_back( i ); }
+    for( typename tiles_type::const_iterator it = tiles.begin(); it != tiles.end(); ++it ) // tiles next to data get a process, too
+    {
+        for( unsigned int n = 0; n < neighbours_(); ++n ) { processes_[ neighbour_( it->first, n ) ]; }
+    }
+    std::vector< index_type > indices;
+    indices.reserve( processes_.size() );
+    for( typename processes_type::const_iterator it = processes_.begin(); it != processes_.end(); ++it ) { indices.push_back( it->first ); }
+    std::vector< boost::shared_ptr< gaussian_process > > processes( indices.size() );
+    tbb::parallel_for( tbb::blocked_range< std::size_t >( 0, indices.size() ), builder( *this, tiles, indices, domains, targets, processes ) );
+    for( std::size_t i = 0; i < indices.size(); ++i ) { processes_[ indices[i] ] = processes[i]; }
+}
+
+template < unsigned int D >
+inline std::vector< std::size_t > local_gaussian_process< D >::neighbourhood_( const tiles_type& tiles, const index_type& index ) const
+{
+    std::vector< std::size_t > rows;
+    for( unsigned int n = 0; n < neighbours_(); ++n )
+    {
+        typename tiles_type::const_iterator it = tiles.find( neighbour_( index, n ) );
+        if( it != tiles.end() ) { rows.insert( rows.end(), it->second.begin(), it->second.end() ); }
+    }
+    if( max_points_ == 0 || rows.size() <= max_points_ ) { return rows; }
+    std::vector< std::size_t > subsampled( max_points_ );
+    for( std::size_t i = 0; i < max_points_; ++i ) { subsampled[i] = rows[ i * rows.size() / max_points_ ]; }
+    return subsampled;
+}
+
+template < unsigned int D >
+inline unsigned int local_gaussian_process< D >::neighbours_()
+{
+    unsigned int count = 1;
+    for( unsigned int i = 0; i < D; ++i ) { count *= 3; }
+    return count;
+}
+
+template < unsigned int D >
+inline typename local_gaussian_process< D >::index_type local_gaussian_process< D >::neighbour_( const index_type& index, unsigned int n ) // n-th offset in { -1, 0, 1 }^D, including the tile itself
+{
+    index_type neighbour = index;
+    for( unsigned int i = 0, k = n; i < D; ++i, k /= 3 ) { neighbour[i] += int( k % 3 ) - 1; }
+    return neighbour;
+}
+
+template < unsigned int D >
+inline void local_gaussian_process< D >::evaluate( const Eigen::MatrixXd& domains, Eigen::VectorXd& means, Eigen::VectorXd& variances ) const
+{
+    if( domains.cols() != D ) { COMMA_THROW( comma::exception, "expected " << D << " column(s) in domains, got " << domains.cols() ); }
+    means.resize( domains.rows() );
+    variances.resize( domains.rows() );
+    tiles_type queries( processes_.resolution() );
+    for( std::size_t i = 0; i < std::size_t( domains.rows() ); ++i ) { queries.touch_at( domains.row( i ).transpose() )->second.push_back( i ); }
+    for( typename tiles_type::const_iterator it = queries.begin(); it != queries.end(); ++it )
+    {
+        const std::vector< std::size_t >& rows = it->second;
+        typename processes_type::const_iterator process = processes_.find( it->first );
+        if( process == processes_.end() )
+        {
+            for( std::size_t r = 0; r < rows.size(); ++r ) { means( rows[r] ) = offset_; variances( rows[r] ) = self_covariance_; }
+            continue;
+        }
+        Eigen::MatrixXd local_domains( rows.size(), domains.cols() );
+        for( std::size_t r = 0; r < rows.size(); ++r ) { local_domains.row( r ) = domains.row( rows[r] ); }
+        Eigen::VectorXd local_means;
+        Eigen::VectorXd local_variances;
+        process->second->evaluate( local_domains, local_means, local_variances );
+        for( std::size_t r = 0; r < rows.size(); ++r ) { means( rows[r] ) = local_means( r ); variances( rows[r] ) = local_variances( r ); }
+    }
+}
+
+template < unsigned int D >
+inline std::pair< double, double > local_gaussian_process< D >::evaluate( const Eigen::MatrixXd& domain ) const
+{
+    if( domain.rows() != 1 ) { COMMA_THROW( comma::exception, "expected 1 row in domain, got " << domain.rows() << " rows" ); }
+    Eigen::VectorXd means( 1 );
+    Eigen::VectorXd variances( 1 );
+    evaluate( domain, means, variances );
+    return std::make_pair( means( 0 ), variances( 0 ) );
+}
+
+} // namespace snark{
+
+#endif // #ifndef SNARK_GAUSSIAN_PROCESS_LOCAL_
@@ -52,13 +52,22 @@ static void test_gaussian_process( const Eigen::MatrixXd& inputDomains
                                      , inputTargets
                                      , boost::bind( &snark::squared_exponential_covariance::covariance, boost::ref( covariance ), _1, _2 )
                                      , covariance.self_covariance() );
+    snark::gaussian_process block_gp( inputDomains
+                                    , inputTargets
+                                    , snark::gaussian_process::block_covariance( boost::bind( &snark::squared_exponential_covariance::block, boost::ref( covariance ), _1, _2, _3 ) )
+                                    , covariance.self_covariance() );
     Eigen::VectorXd outputMeans;
     Eigen::VectorXd outputVariances;
     gp.evaluate( outputDomains, outputMeans, outputVariances );
+    Eigen::VectorXd blockMeans;
+    Eigen::VectorXd blockVariances;
+    block_gp.evaluate( outputDomains, blockMeans, blockVariances );
     for( int i = 0; i < nTestPoints; ++i )
     {
         EXPECT_NEAR( outputMeans(i), matlab_means[i], tolerance );
         EXPECT_NEAR( outputVariances(i), matlab_variances[i], tolerance );
+        EXPECT_NEAR( blockMeans(i), matlab_means[i], tolerance );
+        EXPECT_NEAR( blockVariances(i), matlab_variances[i], tolerance );
     }
 }
 
@@ -215,6 +224,129 @@ TEST( gaussian_process, some )
                          , MATLAB_VARIANCES1Db );
 }
 
+TEST( gaussian_process, block_covariance )
+{
+    snark::squared_exponential_covariance covariance( 2.0, 1.5, 0.1 );
+    Eigen::MatrixXd lhs = Eigen::MatrixXd::Random( 300, 3 ) * 5;
+    Eigen::MatrixXd rhs = Eigen::MatrixXd::Random( 70, 3 ) * 5;
+    Eigen::MatrixXd block;
+    covariance.block( lhs, rhs, block );
+    ASSERT_EQ( 300, block.rows() );
+    ASSERT_EQ( 70, block.cols() );
+    for( int r = 0; r < lhs.rows(); ++r )
+    {
+        for( int c = 0; c < rhs.rows(); ++c ) { EXPECT_NEAR( covariance.covariance( lhs.row( r ), rhs.row( c ) ), block( r, c ), tolerance ); }
+    }
+}
+
+TEST( gaussian_process, many_row_blocks )
+{
+    snark::squared_exponential_covariance covariance( 4.0, 1.0, 0.1 );
+    Eigen::MatrixXd domains = Eigen::MatrixXd::Random( 500, 2 ) * 10;
+    Eigen::VectorXd targets( domains.rows() );
+    for( int i = 0; i < domains.rows(); ++i ) { targets( i ) = std::sin( domains( i, 0 ) ) * std::cos( domains( i, 1 ) ); }
+    Eigen::MatrixXd outputs = Eigen::MatrixXd::Random( 200, 2 ) * 10;
+    snark::gaussian_process gp( domains
+                              , targets
+                              , boost::bind( &snark::squared_exponential_covariance::covariance, boost::ref( covariance ), _1, _2 )
+                              , covariance.self_covariance() );
+    snark::gaussian_process block_gp( domains
+                                    , targets
+                                    , snark::gaussian_process::block_covariance( boost::bind( &snark::squared_exponential_covariance::block, boost::ref( covariance ), _1, _2, _3 ) )
+                                    , covariance.self_covariance() );
+    Eigen::VectorXd means, variances, block_means, block_variances;
+    gp.evaluate( outputs, means, variances );
+    block_gp.evaluate( outputs, block_means, block_variances );
+    for( int i = 0; i < outputs.rows(); ++i )
+    {
+        EXPECT_NEAR( means( i ), block_means( i ), 1e-6 );
+        EXPECT_NEAR( variances( i ), block_variances( i ), 1e-6 );
+    }
+}
+
+TEST( gaussian_process, large_offsets )
+{
+    snark::squared_exponential_covariance covariance( 2.0, 1.0, 0.1 );
+    snark::gaussian_process::block_covariance block( boost::bind( &snark::squared_exponential_covariance::block, boost::ref( covariance ), _1, _2, _3 ) );
+    Eigen::MatrixXd domains = Eigen::MatrixXd::Random( 100, 2 ) * 5;
+    Eigen::VectorXd targets( domains.rows() );
+    for( int i = 0; i < domains.rows(); ++i ) { targets( i ) = std::sin( domains( i, 0 ) ) * std::cos( domains( i, 1 ) ); }
+    Eigen::MatrixXd outputs = Eigen::MatrixXd::Random( 50, 2 ) * 5;
+    snark::gaussian_process gp( domains, targets, block, covariance.self_covariance() );
+    const double offsets[] = { 1e4, 3e5, 6e6 }; // e.g. utm coordinates
+    for( unsigned int k = 0; k < 3; ++k )
+    {
+        Eigen::MatrixXd shifted_domains = domains.array() + offsets[k];
+        Eigen::MatrixXd shifted_outputs = outputs.array() + offsets[k];
+        Eigen::MatrixXd covariances;
+        covariance.block( shifted_outputs, shifted_domains, covariances );
+        for( int r = 0; r < outputs.rows(); ++r )
+        {
+            for( int c = 0; c < domains.rows(); ++c ) { EXPECT_NEAR( covariance.covariance( outputs.row( r ), domains.row( c ) ), covariances( r, c ), 1e-8 ); }
+        }
+        Eigen::VectorXd means, variances, expected_means, expected_variances;
+        snark::gaussian_process( shifted_domains, targets, block, covariance.self_covariance() ).evaluate( shifted_outputs, means, variances );
+        gp.evaluate( outputs, expected_means, expected_variances );
+        for( int i = 0; i < outputs.rows(); ++i )
+        {
+            EXPECT_NEAR( expected_means( i ), means( i ), 1e-6 );
+            EXPECT_NEAR( expected_variances( i ), variances( i ), 1e-6 );
+        }
+    }
+}
+
+static void expect_same( const snark::gaussian_process& lhs, const snark::gaussian_process& rhs, const Eigen::MatrixXd& outputs )
+{
+    Eigen::VectorXd means, variances, expected_means, expected_variances;
+    lhs.evaluate( outputs, means, variances );
+    rhs.evaluate( outputs, expected_means, expected_variances );
+    for( int i = 0; i < outputs.rows(); ++i )
+    {
+        EXPECT_NEAR( expected_means( i ), means( i ), 1e-9 );
+        EXPECT_NEAR( expected_variances( i ), variances( i ), 1e-9 );
+    }
+}
+
+TEST( gaussian_process, insert )
+{
+    snark::squared_exponential_covariance covariance( 1.0, 3.0, 0.1 );
+    snark::gaussian_process::block_covariance block( boost::bind( &snark::squared_exponential_covariance::block, boost::ref( covariance ), _1, _2, _3 ) );
+    Eigen::MatrixXd domains = Eigen::MatrixXd::Random( 40, 2 ) * 3;
+    Eigen::VectorXd targets = Eigen::VectorXd::Random( 40 );
+    Eigen::MatrixXd outputs = Eigen::MatrixXd::Random( 20, 2 ) * 3;
+    snark::gaussian_process gp( domains, targets, block, covariance.self_covariance() );
+    snark::gaussian_process incremental( domains.topRows( 10 ), targets.head( 10 ), block, covariance.self_covariance() );
+    for( int i = 10; i < 30; ++i ) { incremental.insert( domains.row( i ), targets.segment( i, 1 ) ); }
+    incremental.insert( domains.bottomRows( 10 ), targets.tail( 10 ) );
+    EXPECT_EQ( 40u, incremental.size() );
+    expect_same( incremental, gp, outputs );
+}
+
+TEST( gaussian_process, remove )
+{
+    snark::squared_exponential_covariance covariance( 1.0, 3.0, 0.1 );
+    snark::gaussian_process::block_covariance block( boost::bind( &snark::squared_exponential_covariance::block, boost::ref( covariance ), _1, _2, _3 ) );
+    Eigen::MatrixXd domains = Eigen::MatrixXd::Random( 40, 2 ) * 3;
+    Eigen::VectorXd targets = Eigen::VectorXd::Random( 40 );
+    Eigen::MatrixXd outputs = Eigen::MatrixXd::Random( 20, 2 ) * 3;
+    snark::gaussian_process window( domains.topRows( 20 ), targets.head( 20 ), block, covariance.self_covariance() );
+    for( int i = 20; i < 40; ++i ) // sliding window of 20 observations
+    {
+        window.insert( domains.row( i ), targets.segment( i, 1 ) );
+        window.remove( 0 );
+    }
+    EXPECT_EQ( 20u, window.size() );
+    expect_same( window, snark::gaussian_process( domains.bottomRows( 20 ), targets.tail( 20 ), block, covariance.self_covariance() ), outputs );
+    window.remove( 7 );
+    Eigen::MatrixXd expected_domains( 19, 2 );
+    Eigen::VectorXd expected_targets( 19 );
+    expected_domains << domains.middleRows( 20, 7 ), domains.bottomRows( 12 );
+    expected_targets << targets.segment( 20, 7 ), targets.tail( 12 );
+    expect_same( window, snark::gaussian_process( expected_domains, expected_targets, block, covariance.self_covariance() ), outputs );
+    window.remove( 18 );
+    expect_same( window, snark::gaussian_process( expected_domains.topRows( 18 ), expected_targets.head( 18 ), block, covariance.self_covariance() ), outputs );
+}
+
 int gaussian_processTest( int ac, char** av )
 {
     ::testing::InitGoogleTest( &ac, av );
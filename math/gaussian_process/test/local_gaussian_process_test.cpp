@@ -0,0 +1,144 @@
+// This file is part of snark, a generic and flexible library for robotics research
+// Copyright (c) 2011 The University of Sydney
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. All advertising materials mentioning features or use of this software
+//    must display the following acknowledgement:
+//    This product includes software developed by the The University of Sydney.
+// 4. Neither the name of the The University of Sydney nor the
+//    names of its contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+//
+// NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+// GRANTED BY THIS LICENSE.  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+// HOLDERS AND CONTRIBUTORS \"AS IS\" AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+// BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+// OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+// IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <cmath>
+#include <gtest/gtest.h>
+#include <boost/bind.hpp>
+#include <Eigen/Core>
+#include <snark/math/gaussian_process/covariance.h>
+#include <snark/math/gaussian_process/local_gaussian_process.h>
+
+static snark::gaussian_process::block_covariance block_covariance( const snark::squared_exponential_covariance& covariance )
+{
+    return snark::gaussian_process::block_covariance( boost::bind( &snark::squared_exponential_covariance::block, boost::ref( covariance ), _1, _2, _3 ) );
+}
+
+static void make_terrain( std::size_t size, Eigen::MatrixXd& domains, Eigen::VectorXd& targets )
+{
+    domains = ( Eigen::MatrixXd::Random( size, 2 ).array() + 1 ) * 10; // 20x20 metre patch
+    targets.resize( size );
+    for( std::size_t i = 0; i < size; ++i ) { targets( i ) = std::sin( domains( i, 0 ) / 3 ) + std::cos( domains( i, 1 ) / 4 ); }
+}
+
+TEST( local_gaussian_process, single_tile_is_exact )
+{
+    snark::squared_exponential_covariance covariance( 4.0, 1.0, 0.01 );
+    Eigen::MatrixXd domains;
+    Eigen::VectorXd targets;
+    make_terrain( 300, domains, targets );
+    snark::gaussian_process gp( domains, targets, block_covariance( covariance ), covariance.self_covariance() );
+    snark::local_gaussian_process< 2 > local( domains, targets, Eigen::Vector2d( 100, 100 ), block_covariance( covariance ), covariance.self_covariance() );
+    EXPECT_EQ( 9u, local.size() ); // one tile with data and its neighbours
+    Eigen::MatrixXd queries = ( Eigen::MatrixXd::Random( 50, 2 ).array() + 1 ) * 10;
+    Eigen::VectorXd means, variances, local_means, local_variances;
+    gp.evaluate( queries, means, variances );
+    local.evaluate( queries, local_means, local_variances );
+    for( int i = 0; i < queries.rows(); ++i )
+    {
+        EXPECT_NEAR( means( i ), local_means( i ), 1e-9 );
+        EXPECT_NEAR( variances( i ), local_variances( i ), 1e-9 );
+    }
+}
+
+TEST( local_gaussian_process, tiles )
+{
+    snark::squared_exponential_covariance covariance( 4.0, 1.0, 0.01 );
+    Eigen::MatrixXd domains;
+    Eigen::VectorXd targets;
+    make_terrain( 4000, domains, targets );
+    snark::local_gaussian_process< 2 > local( domains, targets, Eigen::Vector2d( 4, 4 ), block_covariance( covariance ), covariance.self_covariance(), 500 );
+    EXPECT_EQ( 49u, local.size() ); // 5x5 tiles with data and a ring of tiles next to them
+    Eigen::MatrixXd queries = ( Eigen::MatrixXd::Random( 200, 2 ).array() + 1 ) * 9.5 + 0.5;
+    Eigen::VectorXd means, variances;
+    local.evaluate( queries, means, variances );
+    for( int i = 0; i < queries.rows(); ++i )
+    {
+        EXPECT_NEAR( std::sin( queries( i, 0 ) / 3 ) + std::cos( queries( i, 1 ) / 4 ), means( i ), 0.05 );
+        EXPECT_LT( variances( i ), 0.1 );
+    }
+}
+
+TEST( local_gaussian_process, empty_tile_next_to_data )
+{
+    snark::squared_exponential_covariance covariance( 4.0, 1.0, 0.01 );
+    Eigen::MatrixXd domains;
+    Eigen::VectorXd targets;
+    make_terrain( 1000, domains, targets );
+    snark::local_gaussian_process< 2 > local( domains, targets, Eigen::Vector2d( 4, 4 ), block_covariance( covariance ), covariance.self_covariance() );
+    Eigen::MatrixXd queries( 3, 2 );
+    queries << 20.2, 10, 10, -0.2, -0.2, -0.2; // just outside of the patch, in tiles without data
+    Eigen::VectorXd means, variances;
+    local.evaluate( queries, means, variances );
+    for( int i = 0; i < queries.rows(); ++i )
+    {
+        EXPECT_NEAR( std::sin( queries( i, 0 ) / 3 ) + std::cos( queries( i, 1 ) / 4 ), means( i ), 0.1 );
+        EXPECT_LT( variances( i ), 0.1 ); // not the prior
+    }
+}
+
+TEST( local_gaussian_process, large_offsets )
+{
+    snark::squared_exponential_covariance covariance( 4.0, 1.0, 0.01 );
+    Eigen::MatrixXd domains;
+    Eigen::VectorXd targets;
+    make_terrain( 2000, domains, targets );
+    Eigen::MatrixXd queries = ( Eigen::MatrixXd::Random( 100, 2 ).array() + 1 ) * 10;
+    const double offset = 6e6; // e.g. utm northing, multiple of resolution, so that tiles stay the same
+    Eigen::MatrixXd shifted_domains = domains.array() + offset;
+    Eigen::MatrixXd shifted_queries = queries.array() + offset;
+    snark::local_gaussian_process< 2 > local( domains, targets, Eigen::Vector2d( 4, 4 ), block_covariance( covariance ), covariance.self_covariance(), 300 );
+    snark::local_gaussian_process< 2 > shifted( shifted_domains, targets, Eigen::Vector2d( 4, 4 ), block_covariance( covariance ), covariance.self_covariance(), 300 );
+    EXPECT_EQ( local.size(), shifted.size() );
+    Eigen::VectorXd means, variances, shifted_means, shifted_variances;
+    local.evaluate( queries, means, variances );
+    shifted.evaluate( shifted_queries, shifted_means, shifted_variances );
+    for( int i = 0; i < queries.rows(); ++i )
+    {
+        EXPECT_NEAR( means( i ), shifted_means( i ), 1e-6 );
+        EXPECT_NEAR( variances( i ), shifted_variances( i ), 1e-6 );
+    }
+}
+
+TEST( local_gaussian_process, prior_outside_data )
+{
+    snark::squared_exponential_covariance covariance( 4.0, 1.0, 0.01 );
+    Eigen::MatrixXd domains;
+    Eigen::VectorXd targets;
+    make_terrain( 100, domains, targets );
+    snark::local_gaussian_process< 2 > local( domains, targets, Eigen::Vector2d( 5, 5 ), block_covariance( covariance ), covariance.self_covariance() );
+    Eigen::MatrixXd query( 1, 2 );
+    query << 100, 100;
+    std::pair< double, double > p = local.evaluate( query );
+    EXPECT_NEAR( targets.sum() / targets.rows(), p.first, 1e-12 );
+    EXPECT_DOUBLE_EQ( covariance.self_covariance(), p.second );
+}
@@ -30,6 +30,8 @@
 // OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
 // IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
+#include <algorithm>
+#include <cmath>
 #include <Eigen/Geometry>
 #include <comma/math/compare.h>
 #include <snark/math/range_bearing_elevation.h>
@@ -188,4 +190,65 @@ Eigen::AngleAxis< double > great_circle_angle_axis( const bearing_elevation& lhs
     return Eigen::AngleAxis< double >( Eigen::Quaternion< double >::FromTwoVectors( a, b ) );
 }
 
+static const std::size_t chunk_size = 256; // to keep temporary arrays on stack and in cache
+
+void to_cartesian( const double* ranges, const double* bearings, const double* elevations
+                 , double* x, double* y, double* z
+                 , std::size_t size
+                 , math::trigonometry::accuracy accuracy )
+{
+    double bearing_sines[ chunk_size ];
+    double bearing_cosines[ chunk_size ];
+    double elevation_sines[ chunk_size ];
+    double elevation_cosines[ chunk_size ];
+    for( std::size_t begin = 0; begin < size; begin += chunk_size )
+    {
+        std::size_t n = std::min( chunk_size, size - begin );
+        math::trigonometry::sin_cos( bearings + begin, bearing_sines, bearing_cosines, n, accuracy );
+        math::trigonometry::sin_cos( elevations + begin, elevation_sines, elevation_cosines, n, accuracy );
+        const double* r = ranges + begin;
+        for( std::size_t i = 0; i < n; ++i )
+        {
+            // as in range_bearing_elevation, negative range negates bearing and elevation, i.e. x uses absolute range
+            double xy_projection = r[i] * elevation_cosines[i];
+            x[ begin + i ] = std::abs( r[i] ) * elevation_cosines[i] * bearing_cosines[i];
+            y[ begin + i ] = xy_projection * bearing_sines[i];
+            z[ begin + i ] = r[i] * elevation_sines[i];
+        }
+    }
+}
+
+void from_cartesian( const double* x, const double* y, const double* z
+                   , double* ranges, double* bearings, double* elevations
+                   , std::size_t size
+                   , math::trigonometry::accuracy accuracy )
+{
+    double xy_projections[ chunk_size ];
+    for( std::size_t begin = 0; begin < size; begin += chunk_size )
+    {
+        std::size_t n = std::min( chunk_size, size - begin );
+        for( std::size_t i = 0; i < n; ++i )
+        {
+            std::size_t j = begin + i;
+            double squared = x[j] * x[j] + y[j] * y[j];
+            xy_projections[i] = std::sqrt( squared );
+            ranges[j] = std::sqrt( squared + z[j] * z[j] );
+        }
+        math::trigonometry::atan2( y + begin, x + begin, bearings + begin, n, accuracy );
+        math::trigonometry::atan2( z + begin, xy_projections, elevations + begin, n, accuracy );
+        double* b = bearings + begin;
+        for( std::size_t i = 0; i < n; ++i ) { b[i] += b[i] < M_PI ? 0 : -M_PI * 2; }
+    }
+}
+
+void normalise_bearings( double* bearings, std::size_t size )
+{
+    for( std::size_t i = 0; i < size; ++i )
+    {
+        double turns = math::trigonometry::round_to_nearest( bearings[i] * ( 0.5 * M_1_PI ) );
+        double b = bearings[i] - M_PI * 2 * turns; // b in [-pi, pi]
+        bearings[i] = b + ( b < M_PI ? 0 : -M_PI * 2 );
+    }
+}
+
 } // namespace snark {
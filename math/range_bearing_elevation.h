@@ -37,6 +37,7 @@
 #include <Eigen/Core>
 #include <Eigen/Geometry>
 #include <comma/math/compare.h>
+#include <snark/math/trigonometry.h>
 
 namespace snark {
 
@@ -126,6 +127,23 @@ typedef range_bearing_elevation rbe;
 /// a convenience function
 Eigen::AngleAxis< double > great_circle_angle_axis( const bearing_elevation& lhs, const bearing_elevation& rhs );
 
+/// batch conversion of arrays of polar points to cartesian, same as range_bearing_elevation::to_cartesian()
+/// input and output arrays may not overlap
+void to_cartesian( const double* ranges, const double* bearings, const double* elevations
+                 , double* x, double* y, double* z
+                 , std::size_t size
+                 , math::trigonometry::accuracy accuracy = math::trigonometry::accurate );
+
+/// batch conversion of arrays of cartesian points to polar
+/// bearings are in [-pi, pi), elevations in [-pi/2, pi/2]; input and output arrays may not overlap
+void from_cartesian( const double* x, const double* y, const double* z
+                   , double* ranges, double* bearings, double* elevations
+                   , std::size_t size
+                   , math::trigonometry::accuracy accuracy = math::trigonometry::accurate );
+
+/// map bearings to [-pi, pi) in place
+void normalise_bearings( double* bearings, std::size_t size );
+
 } // namespace snark {
 
 #endif // SNARK_MATH_RBE_H
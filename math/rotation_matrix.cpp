@@ -31,6 +31,8 @@
 // IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 
+#include <algorithm>
+#include <cmath>
 #include "./rotation_matrix.h"
 
 namespace snark {
@@ -104,6 +106,142 @@ Eigen::Vector3d rotation_matrix::roll_pitch_yaw( const ::Eigen::Matrix3d& m )
     return m;
 }
 
+static const std::size_t chunk_size = 256; // to keep temporary arrays on stack and in cache
+
+void rotation_matrix::rotations( const ::Eigen::Vector3d* rpy, ::Eigen::Matrix3d* rotations, std::size_t size, math::trigonometry::accuracy accuracy )
+{
+    double angles[3][ chunk_size ];
+    double sines[3][ chunk_size ];
+    double cosines[3][ chunk_size ];
+    for( std::size_t begin = 0; begin < size; begin += chunk_size )
+    {
+        std::size_t n = std::min( chunk_size, size - begin );
+        for( std::size_t i = 0; i < n; ++i ) { for( unsigned int k = 0; k < 3; ++k ) { angles[k][i] = rpy[ begin + i ][k]; } }
+        for( unsigned int k = 0; k < 3; ++k ) { math::trigonometry::sin_cos( angles[k], sines[k], cosines[k], n, accuracy ); }
+        for( std::size_t i = 0; i < n; ++i )
+        {
+            const double sr = sines[0][i];
+            const double cr = cosines[0][i];
+            const double sp = sines[1][i];
+            const double cp = cosines[1][i];
+            const double sy = sines[2][i];
+            const double cy = cosines[2][i];
+            const double spcy = sp*cy;
+            const double spsy = sp*sy;
+            ::Eigen::Matrix3d& m = rotations[ begin + i ];
+            m << cp*cy, -cr*sy+sr*spcy,  sr*sy+cr*spcy,
+                 cp*sy,  cr*cy+sr*spsy, -sr*cy+cr*spsy,
+                   -sp,          sr*cp,          cr*cp;
+        }
+    }
+}
+
+void rotation_matrix::quaternions( const ::Eigen::Vector3d* rpy, ::Eigen::Quaterniond* quaternions, std::size_t size, math::trigonometry::accuracy accuracy )
+{
+    double angles[3][ chunk_size ];
+    double sines[3][ chunk_size ];
+    double cosines[3][ chunk_size ];
+    for( std::size_t begin = 0; begin < size; begin += chunk_size )
+    {
+        std::size_t n = std::min( chunk_size, size - begin );
+        for( std::size_t i = 0; i < n; ++i ) { for( unsigned int k = 0; k < 3; ++k ) { angles[k][i] = rpy[ begin + i ][k] * 0.5; } }
+        for( unsigned int k = 0; k < 3; ++k ) { math::trigonometry::sin_cos( angles[k], sines[k], cosines[k], n, accuracy ); }
+        for( std::size_t i = 0; i < n; ++i ) // yaw * pitch * roll, same rotation as rotation( roll, pitch, yaw )
+        {
+            const double sr = sines[0][i];
+            const double cr = cosines[0][i];
+            const double sp = sines[1][i];
+            const double cp = cosines[1][i];
+            const double sy = sines[2][i];
+            const double cy = cosines[2][i];
+            quaternions[ begin + i ] = ::Eigen::Quaterniond( cr*cp*cy + sr*sp*sy
+                                                           , sr*cp*cy - cr*sp*sy
+                                                           , cr*sp*cy + sr*cp*sy
+                                                           , cr*cp*sy - sr*sp*cy );
+        }
+    }
+}
+
+// roll and yaw from atan2, pitch as asin( -m(2,0) ) = atan2( -m(2,0), sqrt( 1 - m(2,0)^2 ) ), which does not fail on rounding beyond 1
+static void roll_pitch_yaw_( double m00[], double m10[], double m20[], double m21[], double m22[], ::Eigen::Vector3d* rpy, std::size_t n, math::trigonometry::accuracy accuracy )
+{
+    double roll[ chunk_size ];
+    double pitch[ chunk_size ];
+    double yaw[ chunk_size ];
+    math::trigonometry::atan2( m21, m22, roll, n, accuracy );
+    math::trigonometry::atan2( m10, m00, yaw, n, accuracy );
+    for( std::size_t i = 0; i < n; ++i ) { m22[i] = std::sqrt( std::max( 1 - m20[i] * m20[i], 0.0 ) ); m20[i] = -m20[i]; }
+    math::trigonometry::atan2( m20, m22, pitch, n, accuracy );
+    for( std::size_t i = 0; i < n; ++i ) { rpy[i] = ::Eigen::Vector3d( roll[i], pitch[i], yaw[i] ); }
+}
+
+void rotation_matrix::roll_pitch_yaw( const ::Eigen::Matrix3d* rotations, ::Eigen::Vector3d* rpy, std::size_t size, math::trigonometry::accuracy accuracy )
+{
+    double m00[ chunk_size ];
+    double m10[ chunk_size ];
+    double m20[ chunk_size ];
+    double m21[ chunk_size ];
+    double m22[ chunk_size ];
+    for( std::size_t begin = 0; begin < size; begin += chunk_size )
+    {
+        std::size_t n = std::min( chunk_size, size - begin );
+        for( std::size_t i = 0; i < n; ++i )
+        {
+            const ::Eigen::Matrix3d& m = rotations[ begin + i ];
+            m00[i] = m(0,0);
+            m10[i] = m(1,0);
+            m20[i] = m(2,0);
+            m21[i] = m(2,1);
+            m22[i] = m(2,2);
+        }
+        roll_pitch_yaw_( m00, m10, m20, m21, m22, rpy + begin, n, accuracy );
+    }
+}
+
+void rotation_matrix::roll_pitch_yaw( const ::Eigen::Quaterniond* quaternions, ::Eigen::Vector3d* rpy, std::size_t size, math::trigonometry::accuracy accuracy )
+{
+    double m00[ chunk_size ];
+    double m10[ chunk_size ];
+    double m20[ chunk_size ];
+    double m21[ chunk_size ];
+    double m22[ chunk_size ];
+    for( std::size_t begin = 0; begin < size; begin += chunk_size )
+    {
+        std::size_t n = std::min( chunk_size, size - begin );
+        for( std::size_t i = 0; i < n; ++i ) // only the matrix elements needed, normalising quaternion on the way
+        {
+            const ::Eigen::Quaterniond& q = quaternions[ begin + i ];
+            const double s = 2 / q.squaredNorm();
+            m00[i] = 1 - s * ( q.y() * q.y() + q.z() * q.z() );
+            m10[i] = s * ( q.x() * q.y() + q.w() * q.z() );
+            m20[i] = s * ( q.x() * q.z() - q.w() * q.y() );
+            m21[i] = s * ( q.y() * q.z() + q.w() * q.x() );
+            m22[i] = 1 - s * ( q.x() * q.x() + q.y() * q.y() );
+        }
+        roll_pitch_yaw_( m00, m10, m20, m21, m22, rpy + begin, n, accuracy );
+    }
+}
+
+void rotation_matrix::compose( const ::Eigen::Quaterniond* lhs, const ::Eigen::Quaterniond* rhs, ::Eigen::Quaterniond* result, std::size_t size )
+{
+    for( std::size_t i = 0; i < size; ++i ) { result[i] = lhs[i] * rhs[i]; }
+}
+
+void rotation_matrix::compose( const ::Eigen::Matrix3d* lhs, const ::Eigen::Matrix3d* rhs, ::Eigen::Matrix3d* result, std::size_t size )
+{
+    for( std::size_t i = 0; i < size; ++i ) { result[i].noalias() = lhs[i] * rhs[i]; }
+}
+
+void rotation_matrix::apply( const ::Eigen::Matrix3d& rotation, const ::Eigen::Vector3d* points, ::Eigen::Vector3d* result, std::size_t size )
+{
+    for( std::size_t i = 0; i < size; ++i ) { result[i] = rotation * points[i]; }
+}
+
+void rotation_matrix::apply( const ::Eigen::Matrix3d* rotations, const ::Eigen::Vector3d* points, ::Eigen::Vector3d* result, std::size_t size )
+{
+    for( std::size_t i = 0; i < size; ++i ) { result[i] = rotations[i] * points[i]; }
+}
+
 // template< typename Output >
 // Output rotation_matrix::convert() const
 // {
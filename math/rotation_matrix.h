@@ -37,6 +37,7 @@
 #include <comma/base/exception.h>
 #include <Eigen/Core>
 #include <Eigen/Geometry>
+#include <snark/math/trigonometry.h>
 
 namespace snark {
 
@@ -55,6 +56,22 @@ public:
     static ::Eigen::Matrix3d rotation( const ::Eigen::Vector3d& rpy );
     static ::Eigen::Matrix3d rotation( double roll, double pitch, double yaw );
 
+    /// batch conversions: arrays of given size in, arrays out, trigonometry vectorised over the batch
+    static void rotations( const ::Eigen::Vector3d* rpy, ::Eigen::Matrix3d* rotations, std::size_t size, math::trigonometry::accuracy accuracy = math::trigonometry::accurate );
+    static void quaternions( const ::Eigen::Vector3d* rpy, ::Eigen::Quaterniond* quaternions, std::size_t size, math::trigonometry::accuracy accuracy = math::trigonometry::accurate );
+    static void roll_pitch_yaw( const ::Eigen::Matrix3d* rotations, ::Eigen::Vector3d* rpy, std::size_t size, math::trigonometry::accuracy accuracy = math::trigonometry::accurate );
+    static void roll_pitch_yaw( const ::Eigen::Quaterniond* quaternions, ::Eigen::Vector3d* rpy, std::size_t size, math::trigonometry::accuracy accuracy = math::trigonometry::accurate );
+
+    /// batch composition: result[i] = lhs[i] * rhs[i]
+    static void compose( const ::Eigen::Quaterniond* lhs, const ::Eigen::Quaterniond* rhs, ::Eigen::Quaterniond* result, std::size_t size );
+    static void compose( const ::Eigen::Matrix3d* lhs, const ::Eigen::Matrix3d* rhs, ::Eigen::Matrix3d* result, std::size_t size );
+
+    /// rotate a batch of points by the same rotation; result may be the same array as points
+    static void apply( const ::Eigen::Matrix3d& rotation, const ::Eigen::Vector3d* points, ::Eigen::Vector3d* result, std::size_t size );
+
+    /// rotate each point by its own rotation: result[i] = rotations[i] * points[i]
+    static void apply( const ::Eigen::Matrix3d* rotations, const ::Eigen::Vector3d* points, ::Eigen::Vector3d* result, std::size_t size );
+
     /// convert to requested type
     template< typename Output >
     Output convert() const;
@@ -0,0 +1,136 @@
+// This file is part of snark, a generic and flexible library for robotics research
+// Copyright (c) 2011 The University of Sydney
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. All advertising materials mentioning features or use of this software
+//    must display the following acknowledgement:
+//    This product includes software developed by the The University of Sydney.
+// 4. Neither the name of the The University of Sydney nor the
+//    names of its contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+//
+// NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+// GRANTED BY THIS LICENSE.  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+// HOLDERS AND CONTRIBUTORS \"AS IS\" AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+// BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+// OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+// IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+/// compare snark::fft against the radix-2 transform it replaced
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/lexical_cast.hpp>
+#include <snark/math/fft/fft.h>
+
+namespace reference {
+
+// previous radix-2 implementation (numerical recipes), kept as a baseline
+template < typename T >
+static void fft( T* data, std::size_t size )
+{
+    unsigned long n, mmax, m, j, istep, i;
+    double wtemp, wr, wpr, wpi, wi, theta;
+    double tempr, tempi;
+    n = size << 1;
+    j = 1;
+    for( i = 1; i < n; i += 2 )
+    {
+        if( j > i )
+        {
+            std::swap( data[ j - 1 ], data[ i - 1 ] );
+            std::swap( data[j], data[i] );
+        }
+        m = size;
+        while( m >= 2 && j > m )
+        {
+            j -= m;
+            m >>= 1;
+        }
+        j += m;
+    }
+    mmax = 2;
+    while( n > mmax )
+    {
+        istep = mmax << 1;
+        theta = -( 2 * M_PI / mmax );
+        wtemp = std::sin( 0.5 * theta );
+        wpr = -2.0 * wtemp * wtemp;
+        wpi = std::sin( theta );
+        wr = 1.0;
+        wi = 0.0;
+        for( m = 1; m < mmax; m += 2 )
+        {
+            for( i = m; i <= n; i += istep )
+            {
+                j = i + mmax;
+                tempr = wr * data[j-1] - wi * data[j];
+                tempi = wr * data[j] + wi * data[j-1];
+                data[j-1] = data[i-1] - tempr;
+                data[j] = data[i] - tempi;
+                data[i-1] += tempr;
+                data[i] += tempi;
+            }
+            wtemp = wr;
+            wr += wr * wpr - wi * wpi;
+            wi += wi * wpr + wtemp * wpi;
+        }
+        mmax = istep;
+    }
+}
+
+} // namespace reference {
+
+static boost::posix_time::ptime now() { return boost::posix_time::microsec_clock::universal_time(); }
+
+// time includes restoring input, not to transform ever growing values
+template < typename T > static double time( void ( *f )( T*, std::size_t ), const std::vector< T >& input, std::size_t size, unsigned int repeat )
+{
+    std::vector< T > data( input.size() );
+    boost::posix_time::ptime start = now();
+    for( unsigned int r = 0; r < repeat; ++r )
+    {
+        std::copy( input.begin(), input.end(), data.begin() );
+        f( &data[0], size );
+    }
+    return double( ( now() - start ).total_microseconds() ) / repeat;
+}
+
+template < typename T > static void run( const std::string& what, std::size_t size, std::size_t total )
+{
+    std::vector< T > input( 2 * size );
+    for( std::size_t i = 0; i < input.size(); ++i ) { input[i] = T( std::rand() ) / RAND_MAX - T( 0.5 ); }
+    unsigned int repeat = std::max< std::size_t >( 1, total / size );
+    double before = time< T >( &reference::fft< T >, input, size, repeat );
+    double after = time< T >( &snark::fft< T >, input, size, repeat );
+    std::cout << what << ", n=" << size << ": " << before << " -> " << after << " microseconds per transform" << std::endl;
+}
+
+int main( int ac, char** av )
+{
+    std::size_t total = ac > 1 ? boost::lexical_cast< std::size_t >( av[1] ) : 1 << 24; // number of points to transform per size
+    static const std::size_t sizes[] = { 1024, 4096, 65536, 1 << 20 };
+    for( unsigned int i = 0; i < 4; ++i ) { run< double >( "double", sizes[i], total ); }
+    for( unsigned int i = 0; i < 4; ++i ) { run< float >( "float", sizes[i], total ); }
+    return 0;
+}
@@ -0,0 +1,153 @@
+// This file is part of snark, a generic and flexible library for robotics research
+// Copyright (c) 2011 The University of Sydney
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. All advertising materials mentioning features or use of this software
+//    must display the following acknowledgement:
+//    This product includes software developed by the The University of Sydney.
+// 4. Neither the name of the The University of Sydney nor the
+//    names of its contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+//
+// NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+// GRANTED BY THIS LICENSE.  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+// HOLDERS AND CONTRIBUTORS \"AS IS\" AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+// BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+// OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+// IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <comma/base/exception.h>
+#include <comma/csv/options.h>
+#include <snark/math/rotation_matrix.h>
+#include <snark/math/applications/frame.h>
+
+namespace snark { namespace applications {
+
+typedef std::vector< boost::shared_ptr< frame > > frames_type;
+
+static const boost::posix_time::ptime start( boost::gregorian::date( 2010, 1, 1 ) );
+
+static boost::posix_time::ptime at( double seconds ) { return start + boost::posix_time::microseconds( static_cast< long >( seconds * 1000000 ) ); }
+
+static void write_nav( const std::string& filename )
+{
+    std::ofstream ofs( filename.c_str() );
+    ofs.precision( 16 );
+    for( unsigned int i = 0; i < 50; ++i ) // yaw wraps around +/-pi on the way
+    {
+        ofs << boost::posix_time::to_iso_string( at( i * 0.1 ) ) << "," << i << "," << std::sin( i * 0.3 ) << "," << 0.1 * i
+            << "," << 0.01 * i << "," << -0.02 * i << "," << std::remainder( 2.5 + 0.1 * i, 2 * M_PI ) << std::endl;
+    }
+}
+
+// static and timestamped frames in a chain, as points-frame --from ... --to ... would build it
+static frames_type make_frames( const std::string& filename, bool interpolate, bool discard )
+{
+    comma::csv::options csv;
+    csv.filename = filename;
+    csv.fields = "t,x,y,z,roll,pitch,yaw";
+    csv.full_xpath = false;
+    frames_type frames;
+    frames.push_back( boost::shared_ptr< frame >( new frame( position( ::Eigen::Vector3d( 1, 2, 3 ), ::Eigen::Vector3d( 0.1, 0.2, 0.3 ) ), false, interpolate, true ) ) );
+    frames.push_back( boost::shared_ptr< frame >( new frame( position( ::Eigen::Vector3d( -1, 0.5, 2 ), ::Eigen::Vector3d( 0, 0, 1 ) ), true, interpolate, true ) ) );
+    frames.push_back( boost::shared_ptr< frame >( new frame( csv, discard, boost::none, false, false, interpolate, true ) ) );
+    frames.push_back( boost::shared_ptr< frame >( new frame( position( ::Eigen::Vector3d( 0.5, 0, 0 ), ::Eigen::Vector3d( 0, 0, -0.5 ) ), false, interpolate, true ) ) );
+    frames.push_back( boost::shared_ptr< frame >( new frame( position( ::Eigen::Vector3d( 0, 0, 1 ), ::Eigen::Vector3d( 0.3, 0, 0 ) ), true, interpolate, true ) ) );
+    return frames;
+}
+
+enum status { converted, discarded, end };
+
+// same as points-frame without --parallel
+static status streamed( const frames_type& frames, const frame::point_type& point, frame::point_type& result )
+{
+    result = point;
+    for( std::size_t i = 0; i < frames.size(); ++i )
+    {
+        const frame::point_type* c = frames[i]->converted( result );
+        if( c == NULL ) { return frames[i]->discarded() ? discarded : end; }
+        result = *c;
+    }
+    return converted;
+}
+
+// same as points-frame --parallel for a single point: read stage checks time order, conversion stage converts
+static status parallel( const frames_type& frames, const frame::point_type& point, frame::point_type& result, boost::posix_time::ptime& latest )
+{
+    for( std::size_t i = 0; i < frames.size(); ++i ) { if( frames[i]->out_of_order( point.t, latest ) ) { return discarded; } }
+    if( latest.is_special() || point.t > latest ) { latest = point.t; }
+    result = point;
+    for( std::size_t i = 0; i < frames.size(); ++i )
+    {
+        frame::point_type c;
+        bool d;
+        if( frames[i]->converted( result, c, d ) == NULL ) { return d ? discarded : end; }
+        result = c;
+    }
+    return converted;
+}
+
+TEST( frame, parallel_same_as_streaming )
+{
+    const std::string filename = "frame_test_nav.csv";
+    write_nav( filename );
+    for( unsigned int k = 0; k < 4; ++k )
+    {
+        bool interpolate = k % 2 == 0;
+        bool discard = k < 2;
+        frames_type frames = make_frames( filename, interpolate, discard );
+        frames_type composed = compose( make_frames( filename, interpolate, discard ), true );
+        ASSERT_EQ( 3u, composed.size() ); // static frames on either side of nav are composed
+        EXPECT_TRUE( composed[0]->is_static() );
+        EXPECT_FALSE( composed[1]->is_static() );
+        EXPECT_TRUE( composed[2]->is_static() );
+        for( std::size_t i = 0; i < composed.size(); ++i ) { composed[i]->preload(); }
+        boost::posix_time::ptime latest;
+        unsigned int backwards = 0;
+        for( unsigned int i = 0; i < 200; ++i )
+        {
+            frame::point_type point;
+            point.t = at( 0.013 + i * 0.024 - ( i % 7 == 3 ? 0.25 : i % 7 == 5 ? 0.03 : 0 ) ); // some points go back in time by one or more nav intervals
+            point.value = position( ::Eigen::Vector3d( std::sin( i * 0.7 ) * 10, std::cos( i * 0.3 ) * 5, i * 0.1 ), ::Eigen::Vector3d( 0.05 * std::sin( i * 0.2 ), 0.1, 0.02 * i - 2 ) );
+            frame::point_type expected, result;
+            status e = end;
+            status r = end;
+            bool streamed_threw = false;
+            bool parallel_threw = false;
+            try { e = streamed( frames, point, expected ); } catch( const comma::exception& ) { streamed_threw = true; }
+            try { r = parallel( composed, point, result, latest ); } catch( const comma::exception& ) { parallel_threw = true; }
+            ASSERT_EQ( streamed_threw, parallel_threw ) << "at " << boost::posix_time::to_iso_string( point.t );
+            if( streamed_threw ) { EXPECT_FALSE( discard ); ++backwards; continue; }
+            ASSERT_EQ( e, r ) << "at " << boost::posix_time::to_iso_string( point.t );
+            if( e == discarded ) { EXPECT_TRUE( discard ); ++backwards; continue; }
+            if( e == end ) { EXPECT_GT( point.t, at( 4.9 ) ); break; } // end of nav data
+            EXPECT_EQ( expected.t, result.t );
+            EXPECT_NEAR( 0, ( expected.value.coordinates - result.value.coordinates ).norm(), 1e-9 );
+            ::Eigen::Matrix3d difference = snark::rotation_matrix::rotation( expected.value.orientation ).transpose() * snark::rotation_matrix::rotation( result.value.orientation );
+            EXPECT_NEAR( 0, ( difference - ::Eigen::Matrix3d::Identity() ).norm(), 1e-9 );
+        }
+        EXPECT_LT( 0u, backwards );
+    }
+    std::remove( filename.c_str() );
+}
+
+} } // namespace snark { namespace applications {
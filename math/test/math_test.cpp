@@ -31,9 +31,14 @@
 // IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 
+#include <vector>
 #include <gtest/gtest.h>
+#include <Eigen/StdVector>
+#include <snark/math/fft/fft.h>
 #include <snark/math/interval.h>
 #include <snark/math/range_bearing_elevation.h>
+#include <snark/math/rotation_matrix.h>
+#include <snark/math/trigonometry.h>
 
 namespace snark { namespace math {
 
@@ -132,6 +137,157 @@ TEST( math, great_circle_angle_axis )
     // todo: certainly more testing...
 }
 
+TEST( math, trigonometry )
+{
+    std::vector< double > angles;
+    for( double a = -50; a < 50; a += 0.01 ) { angles.push_back( a ); }
+    angles.push_back( M_PI / 4 );
+    angles.push_back( -M_PI / 2 );
+    angles.push_back( 1000 * M_PI );
+    std::vector< double > sines( angles.size() );
+    std::vector< double > cosines( angles.size() );
+    trigonometry::sin_cos( &angles[0], &sines[0], &cosines[0], angles.size(), trigonometry::accurate );
+    for( std::size_t i = 0; i < angles.size(); ++i )
+    {
+        EXPECT_NEAR( std::sin( angles[i] ), sines[i], 1e-14 );
+        EXPECT_NEAR( std::cos( angles[i] ), cosines[i], 1e-14 );
+    }
+    trigonometry::sin_cos( &angles[0], &sines[0], &cosines[0], angles.size(), trigonometry::fast );
+    for( std::size_t i = 0; i < angles.size(); ++i )
+    {
+        EXPECT_NEAR( std::sin( angles[i] ), sines[i], 1e-6 );
+        EXPECT_NEAR( std::cos( angles[i] ), cosines[i], 1e-6 );
+    }
+    std::vector< double > y;
+    std::vector< double > x;
+    for( double a = -M_PI; a <= M_PI; a += 0.001 ) { y.push_back( std::sin( a ) * 3 ); x.push_back( std::cos( a ) * 3 ); }
+    double signed_zeros[][2] = { { 0, 0 }, { 0, -0.0 }, { -0.0, 0 }, { -0.0, -0.0 }, { 0, -1 }, { -0.0, -1 }, { 1, 0 }, { -1, 0 } };
+    for( unsigned int i = 0; i < 8; ++i ) { y.push_back( signed_zeros[i][0] ); x.push_back( signed_zeros[i][1] ); }
+    std::vector< double > a( y.size() );
+    trigonometry::atan2( &y[0], &x[0], &a[0], y.size(), trigonometry::accurate );
+    for( std::size_t i = 0; i < y.size(); ++i ) { EXPECT_NEAR( std::atan2( y[i], x[i] ), a[i], 1e-15 ); }
+    trigonometry::atan2( &y[0], &x[0], &a[0], y.size(), trigonometry::fast );
+    for( std::size_t i = 0; i < y.size(); ++i ) { EXPECT_NEAR( std::atan2( y[i], x[i] ), a[i], 1e-6 ); }
+}
+
+TEST( math, range_bearing_elevation_batch )
+{
+    std::vector< double > r;
+    std::vector< double > b;
+    std::vector< double > e;
+    for( double range = -2; range < 2; range += 0.7 )
+    {
+        for( double bearing = -7; bearing < 7; bearing += 0.3 )
+        {
+            for( double elevation = -4; elevation < 4; elevation += 0.3 ) { r.push_back( range ); b.push_back( bearing ); e.push_back( elevation ); }
+        }
+    }
+    std::vector< double > x( r.size() );
+    std::vector< double > y( r.size() );
+    std::vector< double > z( r.size() );
+    to_cartesian( &r[0], &b[0], &e[0], &x[0], &y[0], &z[0], r.size() );
+    for( std::size_t i = 0; i < r.size(); ++i )
+    {
+        Eigen::Vector3d expected = snark::range_bearing_elevation( r[i], b[i], e[i] ).to_cartesian();
+        EXPECT_NEAR( expected.x(), x[i], 1e-12 );
+        EXPECT_NEAR( expected.y(), y[i], 1e-12 );
+        EXPECT_NEAR( expected.z(), z[i], 1e-12 );
+    }
+    std::vector< double > ranges( r.size() );
+    std::vector< double > bearings( r.size() );
+    std::vector< double > elevations( r.size() );
+    from_cartesian( &x[0], &y[0], &z[0], &ranges[0], &bearings[0], &elevations[0], r.size() );
+    for( std::size_t i = 0; i < r.size(); ++i )
+    {
+        EXPECT_NEAR( std::abs( r[i] ), ranges[i], 1e-12 );
+        EXPECT_LE( -M_PI, bearings[i] );
+        EXPECT_GT( M_PI, bearings[i] );
+        EXPECT_LE( -M_PI / 2, elevations[i] );
+        EXPECT_GE( M_PI / 2, elevations[i] );
+        Eigen::Vector3d v = snark::range_bearing_elevation( ranges[i], bearings[i], elevations[i] ).to_cartesian();
+        EXPECT_NEAR( x[i], v.x(), 1e-12 );
+        EXPECT_NEAR( y[i], v.y(), 1e-12 );
+        EXPECT_NEAR( z[i], v.z(), 1e-12 );
+    }
+    double bearing_values[] = { M_PI, -M_PI, M_PI * 2, M_PI * 1.5, M_PI * 20, -7, 0.5 };
+    std::vector< double > normalised( bearing_values, bearing_values + 7 );
+    normalise_bearings( &normalised[0], normalised.size() );
+    for( std::size_t i = 0; i < normalised.size(); ++i ) { EXPECT_NEAR( snark::bearing_elevation( bearing_values[i], 0 ).b(), normalised[i], 1e-12 ); }
+}
+
+TEST( math, rotation_matrix_batch )
+{
+    typedef std::vector< Eigen::Quaterniond, Eigen::aligned_allocator< Eigen::Quaterniond > > quaternions_t;
+    std::vector< Eigen::Vector3d > rpy;
+    for( double roll = -3; roll < 3; roll += 0.5 )
+    {
+        for( double pitch = -1.5; pitch < 1.5; pitch += 0.25 )
+        {
+            for( double yaw = -7; yaw < 7; yaw += 0.5 ) { rpy.push_back( Eigen::Vector3d( roll, pitch, yaw ) ); }
+        }
+    }
+    std::vector< Eigen::Matrix3d > rotations( rpy.size() );
+    quaternions_t quaternions( rpy.size() );
+    std::vector< Eigen::Vector3d > from_rotations( rpy.size() );
+    std::vector< Eigen::Vector3d > from_quaternions( rpy.size() );
+    rotation_matrix::rotations( &rpy[0], &rotations[0], rpy.size() );
+    rotation_matrix::quaternions( &rpy[0], &quaternions[0], rpy.size() );
+    rotation_matrix::roll_pitch_yaw( &rotations[0], &from_rotations[0], rpy.size() );
+    rotation_matrix::roll_pitch_yaw( &quaternions[0], &from_quaternions[0], rpy.size() );
+    for( std::size_t i = 0; i < rpy.size(); ++i )
+    {
+        Eigen::Matrix3d expected = rotation_matrix::rotation( rpy[i] );
+        EXPECT_TRUE( expected.isApprox( rotations[i], 1e-12 ) );
+        EXPECT_TRUE( expected.isApprox( quaternions[i].toRotationMatrix(), 1e-12 ) );
+        Eigen::Vector3d expected_rpy = rotation_matrix::roll_pitch_yaw( expected );
+        EXPECT_TRUE( expected_rpy.isApprox( from_rotations[i], 1e-9 ) );
+        EXPECT_TRUE( expected_rpy.isApprox( from_quaternions[i], 1e-9 ) );
+    }
+    rotation_matrix::quaternions( &rpy[0], &quaternions[0], rpy.size(), trigonometry::fast );
+    for( std::size_t i = 0; i < rpy.size(); ++i ) { EXPECT_TRUE( rotation_matrix::rotation( rpy[i] ).isApprox( quaternions[i].toRotationMatrix(), 1e-5 ) ); }
+    quaternions_t composed( rpy.size() );
+    rotation_matrix::quaternions( &rpy[0], &quaternions[0], rpy.size() );
+    rotation_matrix::compose( &quaternions[0], &quaternions[0], &composed[0], rpy.size() );
+    std::vector< Eigen::Matrix3d > composed_rotations( rpy.size() );
+    rotation_matrix::compose( &rotations[0], &rotations[0], &composed_rotations[0], rpy.size() );
+    std::vector< Eigen::Vector3d > points( rpy.size() );
+    for( std::size_t i = 0; i < points.size(); ++i ) { points[i] = Eigen::Vector3d( i * 0.1, 1 - i * 0.01, 2 ); }
+    std::vector< Eigen::Vector3d > rotated( points.size() );
+    rotation_matrix::apply( &composed_rotations[0], &points[0], &rotated[0], points.size() );
+    for( std::size_t i = 0; i < points.size(); ++i )
+    {
+        EXPECT_TRUE( ( rotations[i] * rotations[i] ).isApprox( composed[i].toRotationMatrix(), 1e-12 ) );
+        EXPECT_TRUE( ( rotations[i] * ( rotations[i] * points[i] ) ).isApprox( rotated[i], 1e-12 ) );
+    }
+    rotated = points;
+    rotation_matrix::apply( rotations[7], &rotated[0], &rotated[0], rotated.size() );
+    for( std::size_t i = 0; i < points.size(); ++i ) { EXPECT_TRUE( ( rotations[7] * points[i] ).isApprox( rotated[i], 1e-12 ) ); }
+}
+
+TEST( math, fft )
+{
+    for( std::size_t size = 1; size <= 512; size <<= 1 ) // odd and even powers of 2
+    {
+        std::vector< double > x( 2 * size );
+        for( std::size_t i = 0; i < x.size(); ++i ) { x[i] = std::sin( 0.3 * i ) + 0.1 * ( i % 7 ); }
+        std::vector< double > y = x;
+        snark::fft( &y[0], size );
+        for( std::size_t k = 0; k < size; ++k )
+        {
+            double re = 0;
+            double im = 0;
+            for( std::size_t n = 0; n < size; ++n )
+            {
+                double a = -2 * M_PI * k * n / size;
+                re += x[ 2 * n ] * std::cos( a ) - x[ 2 * n + 1 ] * std::sin( a );
+                im += x[ 2 * n ] * std::sin( a ) + x[ 2 * n + 1 ] * std::cos( a );
+            }
+            EXPECT_NEAR( re, y[ 2 * k ], 1e-9 );
+            EXPECT_NEAR( im, y[ 2 * k + 1 ], 1e-9 );
+        }
+    }
+}
+
 } }
 
 int main(int argc, char *argv[])
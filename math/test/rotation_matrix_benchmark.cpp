@@ -0,0 +1,105 @@
+// This file is part of snark, a generic and flexible library for robotics research
+// Copyright (c) 2011 The University of Sydney
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. All advertising materials mentioning features or use of this software
+//    must display the following acknowledgement:
+//    This product includes software developed by the The University of Sydney.
+// 4. Neither the name of the The University of Sydney nor the
+//    names of its contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+//
+// NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+// GRANTED BY THIS LICENSE.  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+// HOLDERS AND CONTRIBUTORS \"AS IS\" AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+// BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+// OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+// IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+/// compare batch rotation conversions against per-rotation calls
+
+#include <iostream>
+#include <vector>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/lexical_cast.hpp>
+#include <Eigen/StdVector>
+#include <snark/math/rotation_matrix.h>
+
+typedef std::vector< Eigen::Quaterniond, Eigen::aligned_allocator< Eigen::Quaterniond > > quaternions_t;
+
+static boost::posix_time::ptime now() { return boost::posix_time::microsec_clock::universal_time(); }
+
+static void report( const std::string& what, const boost::posix_time::ptime& start, std::size_t size )
+{
+    std::cout << what << ": " << double( ( now() - start ).total_microseconds() ) * 1000 / size << " ns per rotation" << std::endl;
+}
+
+int main( int ac, char** av )
+{
+    std::size_t size = ac > 1 ? boost::lexical_cast< std::size_t >( av[1] ) : 1000000;
+    std::vector< Eigen::Vector3d > rpy( size );
+    for( std::size_t i = 0; i < size; ++i ) { rpy[i] = Eigen::Vector3d( 0.001 * ( i % 3000 ) - 1.5, 0.0005 * ( i % 2000 ) - 0.5, 0.0001 * i - 3 ); }
+    std::vector< Eigen::Matrix3d > rotations( size, Eigen::Matrix3d::Zero() ); // initialised, not to time page faults
+    quaternions_t quaternions( size, Eigen::Quaterniond::Identity() );
+    std::vector< Eigen::Vector3d > angles( size, Eigen::Vector3d::Zero() );
+    boost::posix_time::ptime start = now();
+    for( std::size_t i = 0; i < size; ++i ) { rotations[i] = snark::rotation_matrix::rotation( rpy[i] ); }
+    report( "rpy to rotation, scalar", start, size );
+    static const char* accuracies[] = { "fast", "accurate", "exact" };
+    for( unsigned int a = 0; a < 3; ++a )
+    {
+        start = now();
+        snark::rotation_matrix::rotations( &rpy[0], &rotations[0], size, snark::math::trigonometry::accuracy( a ) );
+        report( std::string( "rpy to rotation, batch, " ) + accuracies[a], start, size );
+    }
+    start = now();
+    for( std::size_t i = 0; i < size; ++i ) { quaternions[i] = Eigen::Quaterniond( snark::rotation_matrix::rotation( rpy[i] ) ); }
+    report( "rpy to quaternion, scalar", start, size );
+    for( unsigned int a = 0; a < 3; ++a )
+    {
+        start = now();
+        snark::rotation_matrix::quaternions( &rpy[0], &quaternions[0], size, snark::math::trigonometry::accuracy( a ) );
+        report( std::string( "rpy to quaternion, batch, " ) + accuracies[a], start, size );
+    }
+    start = now();
+    for( std::size_t i = 0; i < size; ++i ) { angles[i] = snark::rotation_matrix( quaternions[i] ).roll_pitch_yaw(); }
+    report( "quaternion to rpy, scalar", start, size );
+    for( unsigned int a = 0; a < 3; ++a )
+    {
+        start = now();
+        snark::rotation_matrix::roll_pitch_yaw( &quaternions[0], &angles[0], size, snark::math::trigonometry::accuracy( a ) );
+        report( std::string( "quaternion to rpy, batch, " ) + accuracies[a], start, size );
+    }
+    start = now();
+    for( std::size_t i = 0; i < size; ++i ) { angles[i] = snark::rotation_matrix::roll_pitch_yaw( rotations[i] ); }
+    report( "rotation to rpy, scalar", start, size );
+    for( unsigned int a = 0; a < 3; ++a )
+    {
+        start = now();
+        snark::rotation_matrix::roll_pitch_yaw( &rotations[0], &angles[0], size, snark::math::trigonometry::accuracy( a ) );
+        report( std::string( "rotation to rpy, batch, " ) + accuracies[a], start, size );
+    }
+    std::vector< Eigen::Vector3d > points( rpy );
+    start = now();
+    for( std::size_t i = 0; i < size; ++i ) { points[i] = rotations[0] * rpy[i]; }
+    report( "apply rotation, scalar", start, size );
+    start = now();
+    snark::rotation_matrix::apply( rotations[0], &rpy[0], &points[0], size );
+    report( "apply rotation, batch", start, size );
+    return 0;
+}
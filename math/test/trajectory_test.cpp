@@ -0,0 +1,125 @@
+// This file is part of snark, a generic and flexible library for robotics research
+// Copyright (c) 2011 The University of Sydney
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. All advertising materials mentioning features or use of this software
+//    must display the following acknowledgement:
+//    This product includes software developed by the The University of Sydney.
+// 4. Neither the name of the The University of Sydney nor the
+//    names of its contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+//
+// NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+// GRANTED BY THIS LICENSE.  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+// HOLDERS AND CONTRIBUTORS \"AS IS\" AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+// BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+// OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+// IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <cmath>
+#include <gtest/gtest.h>
+#include <comma/base/exception.h>
+#include <comma/base/types.h>
+#include <snark/math/rotation_matrix.h>
+#include <snark/math/applications/trajectory.h>
+
+namespace snark { namespace applications {
+
+static const boost::posix_time::ptime start( boost::gregorian::date( 2010, 1, 1 ) );
+
+static boost::posix_time::ptime at( double seconds ) { return start + boost::posix_time::microseconds( static_cast< comma::int64 >( seconds * 1000000 ) ); }
+
+static void expect_pose( const trajectory& t, double seconds, const ::Eigen::Vector3d& coordinates, const ::Eigen::Vector3d& orientation, bool interpolate = true )
+{
+    ::Eigen::Vector3d c;
+    ::Eigen::Quaterniond q;
+    ASSERT_EQ( trajectory::found, t.pose( at( seconds ), interpolate, boost::none, c, q ) );
+    EXPECT_NEAR( 0, ( c - coordinates ).norm(), 1e-9 );
+    EXPECT_NEAR( 1, std::abs( q.dot( snark::rotation_matrix( orientation ).quaternion() ) ), 1e-9 ); // q and -q are the same rotation
+}
+
+TEST( trajectory, boundaries )
+{
+    trajectory t;
+    t.push_back( at( 0 ), ::Eigen::Vector3d( 0, 0, 0 ), ::Eigen::Vector3d( 0, 0, 0.1 ) );
+    t.push_back( at( 1 ), ::Eigen::Vector3d( 1, 2, 3 ), ::Eigen::Vector3d( 0, 0, 0.3 ) );
+    t.push_back( at( 2 ), ::Eigen::Vector3d( 2, 4, 6 ), ::Eigen::Vector3d( 0, 0, 0.5 ) );
+    t.commit();
+    ::Eigen::Vector3d c;
+    ::Eigen::Quaterniond q;
+    EXPECT_EQ( trajectory::before, t.pose( at( -0.001 ), true, boost::none, c, q ) );
+    EXPECT_EQ( trajectory::after, t.pose( at( 2.001 ), true, boost::none, c, q ) );
+    expect_pose( t, 0, ::Eigen::Vector3d( 0, 0, 0 ), ::Eigen::Vector3d( 0, 0, 0.1 ) );
+    expect_pose( t, 1, ::Eigen::Vector3d( 1, 2, 3 ), ::Eigen::Vector3d( 0, 0, 0.3 ) );
+    expect_pose( t, 2, ::Eigen::Vector3d( 2, 4, 6 ), ::Eigen::Vector3d( 0, 0, 0.5 ) );
+    expect_pose( t, 0.5, ::Eigen::Vector3d( 0.5, 1, 1.5 ), ::Eigen::Vector3d( 0, 0, 0.2 ) );
+    expect_pose( t, 1.75, ::Eigen::Vector3d( 1.75, 3.5, 5.25 ), ::Eigen::Vector3d( 0, 0, 0.45 ) );
+    expect_pose( t, 0.4, ::Eigen::Vector3d( 0, 0, 0 ), ::Eigen::Vector3d( 0, 0, 0.1 ), false ); // nearest
+    expect_pose( t, 0.6, ::Eigen::Vector3d( 1, 2, 3 ), ::Eigen::Vector3d( 0, 0, 0.3 ), false );
+    trajectory single;
+    EXPECT_THROW( single.pose( at( 0 ), true, boost::none, c, q ), comma::exception );
+    single.push_back( at( 1 ), ::Eigen::Vector3d( 1, 2, 3 ), ::Eigen::Vector3d( 0, 0, 0.3 ) );
+    single.commit();
+    expect_pose( single, 1, ::Eigen::Vector3d( 1, 2, 3 ), ::Eigen::Vector3d( 0, 0, 0.3 ) );
+    EXPECT_EQ( trajectory::before, single.pose( at( 0.999 ), true, boost::none, c, q ) );
+    EXPECT_EQ( trajectory::after, single.pose( at( 1.001 ), true, boost::none, c, q ) );
+}
+
+TEST( trajectory, gap )
+{
+    trajectory t;
+    t.push_back( at( 0 ), ::Eigen::Vector3d( 0, 0, 0 ), ::Eigen::Vector3d( 0, 0, 0 ) );
+    t.push_back( at( 1 ), ::Eigen::Vector3d( 1, 0, 0 ), ::Eigen::Vector3d( 0, 0, 0 ) );
+    t.push_back( at( 11 ), ::Eigen::Vector3d( 11, 0, 0 ), ::Eigen::Vector3d( 0, 0, 0 ) );
+    t.commit();
+    boost::optional< boost::posix_time::time_duration > max_gap = boost::posix_time::seconds( 2 );
+    ::Eigen::Vector3d c;
+    ::Eigen::Quaterniond q;
+    EXPECT_EQ( trajectory::found, t.pose( at( 0.5 ), true, max_gap, c, q ) );
+    EXPECT_NEAR( 0.5, c.x(), 1e-9 );
+    EXPECT_EQ( trajectory::gap, t.pose( at( 5 ), true, max_gap, c, q ) );
+    EXPECT_EQ( trajectory::gap, t.pose( at( 1.001 ), true, max_gap, c, q ) );
+    EXPECT_EQ( trajectory::found, t.pose( at( 1 ), true, max_gap, c, q ) ); // on a sample, interval before it is taken
+    EXPECT_NEAR( 1, c.x(), 1e-9 );
+    EXPECT_EQ( trajectory::found, t.pose( at( 5 ), true, boost::none, c, q ) );
+    EXPECT_NEAR( 5, c.x(), 1e-9 );
+}
+
+TEST( trajectory, out_of_order )
+{
+    const double times[] = { 3, 0, 4, 1, 2 };
+    trajectory t;
+    for( unsigned int i = 0; i < 3; ++i ) { t.push_back( at( times[i] ), ::Eigen::Vector3d( times[i], 0, 0 ), ::Eigen::Vector3d( 0, 0, times[i] * 0.2 ) ); }
+    t.commit();
+    for( unsigned int i = 3; i < 5; ++i ) { t.push_back( at( times[i] ), ::Eigen::Vector3d( times[i], 0, 0 ), ::Eigen::Vector3d( 0, 0, times[i] * 0.2 ) ); } // more samples after commit
+    t.commit();
+    ASSERT_EQ( 5u, t.size() );
+    for( trajectory::const_iterator it = t.begin() + 1; it != t.end(); ++it ) { EXPECT_LT( ( it - 1 )->t, it->t ); }
+    for( unsigned int i = 0; i <= 40; ++i ) { expect_pose( t, i * 0.1, ::Eigen::Vector3d( i * 0.1, 0, 0 ), ::Eigen::Vector3d( 0, 0, i * 0.02 ) ); }
+}
+
+TEST( trajectory, yaw_wrap )
+{
+    trajectory t;
+    t.push_back( at( 0 ), ::Eigen::Vector3d( 0, 0, 0 ), ::Eigen::Vector3d( 0, 0, M_PI - 0.1 ) );
+    t.push_back( at( 1 ), ::Eigen::Vector3d( 0, 0, 0 ), ::Eigen::Vector3d( 0, 0, -M_PI + 0.1 ) );
+    t.commit();
+    expect_pose( t, 0.5, ::Eigen::Vector3d( 0, 0, 0 ), ::Eigen::Vector3d( 0, 0, M_PI ) ); // not through zero
+}
+
+} } // namespace snark { namespace applications {
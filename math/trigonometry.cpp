@@ -0,0 +1,164 @@
+// This file is part of snark, a generic and flexible library for robotics research
+// Copyright (c) 2011 The University of Sydney
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. All advertising materials mentioning features or use of this software
+//    must display the following acknowledgement:
+//    This product includes software developed by the The University of Sydney.
+// 4. Neither the name of the The University of Sydney nor the
+//    names of its contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+//
+// NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+// GRANTED BY THIS LICENSE.  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+// HOLDERS AND CONTRIBUTORS \"AS IS\" AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+// BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+// OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+// IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <comma/base/exception.h>
+#include <snark/math/trigonometry.h>
+
+namespace snark { namespace math { namespace trigonometry {
+
+// pi/2 split into three parts for exact range reduction; polynomial coefficients below are from cephes
+static const double pi_2_1 = 1.57079625129699707031e+00;
+static const double pi_2_2 = 7.54978941586159635335e-08;
+static const double pi_2_3 = 5.39030285815811290290e-15;
+
+accuracy accuracy_from_string( const char* s )
+{
+    if( std::strcmp( s, "fast" ) == 0 ) { return fast; }
+    if( std::strcmp( s, "accurate" ) == 0 ) { return accurate; }
+    if( std::strcmp( s, "exact" ) == 0 ) { return exact; }
+    COMMA_THROW( comma::exception, "expected accuracy: fast, accurate or exact; got: \"" << s << "\"" );
+}
+
+template < accuracy A > struct polynomial;
+
+template <> struct polynomial< fast >
+{
+    static double sin( double x, double z ) { return x + x * z * ( -1.0 / 6 + z * ( 1.0 / 120 + z * ( -1.0 / 5040 ) ) ); }
+    static double cos( double z ) { return 1 - z * 0.5 + z * z * ( 1.0 / 24 + z * ( -1.0 / 720 + z * ( 1.0 / 40320 ) ) ); }
+    static double atan( double x, double z ) { return x + x * z * ( -1.0 / 3 + z * ( 1.0 / 5 + z * ( -1.0 / 7 + z * ( 1.0 / 9 + z * ( -1.0 / 11 + z * ( 1.0 / 13 ) ) ) ) ) ); }
+};
+
+template <> struct polynomial< accurate >
+{
+    static double sin( double x, double z )
+    {
+        return x + x * z * ( -1.66666666666666307295e-01
+                           + z * ( 8.33333333332211858878e-03
+                           + z * ( -1.98412698295895385996e-04
+                           + z * ( 2.75573136213857245213e-06
+                           + z * ( -2.50507477628578072866e-08
+                           + z * 1.58962301576546568060e-10 ) ) ) ) );
+    }
+
+    static double cos( double z )
+    {
+        return 1 - z * 0.5 + z * z * ( 4.16666666666665929218e-02
+                                     + z * ( -1.38888888888730564116e-03
+                                     + z * ( 2.48015872888517045348e-05
+                                     + z * ( -2.75573141792967388112e-07
+                                     + z * ( 2.08757008419747316778e-09
+                                     + z * -1.13585365213876817300e-11 ) ) ) ) );
+    }
+
+    static double atan( double x, double z )
+    {
+        double n = ( ( ( -8.750608600031904122785e-01 * z - 1.615753718733365076637e+01 ) * z - 7.500855792314704667340e+01 ) * z - 1.228866684490136173410e+02 ) * z - 6.485021904942025371773e+01;
+        double d = ( ( ( ( z + 2.485846490142306297962e+01 ) * z + 1.650270098316988542046e+02 ) * z + 4.328810604912902668951e+02 ) * z + 4.853903996359136964868e+02 ) * z + 1.945506571482613964425e+02;
+        return x + x * z * n / d;
+    }
+};
+
+template < accuracy A >
+static void sin_cos_( const double* angles, double* sines, double* cosines, std::size_t size )
+{
+    for( std::size_t i = 0; i < size; ++i )
+    {
+        double k = round_to_nearest( angles[i] * M_2_PI );
+        double x = ( ( angles[i] - k * pi_2_1 ) - k * pi_2_2 ) - k * pi_2_3; // x in [-pi/4, pi/4]
+        double quadrant = k - 4 * round_to_nearest( k * 0.25 - 0.375 ); // 0, 1, 2 or 3
+        double z = x * x;
+        double s = polynomial< A >::sin( x, z );
+        double c = polynomial< A >::cos( z );
+        bool odd = quadrant == 1 || quadrant == 3;
+        double sine = odd ? c : s;
+        double cosine = odd ? s : c;
+        sines[i] = quadrant < 2 ? sine : -sine;
+        cosines[i] = quadrant == 1 || quadrant == 2 ? -cosine : cosine;
+    }
+}
+
+// atan( t ) = 2 * atan( t / ( 1 + sqrt( 1 + t^2 ) ) ) reduces t in [0, 1] to [0, tan( pi/8 )] without branching
+template < accuracy A >
+static void atan2_( const double* y, const double* x, double* angles, std::size_t size )
+{
+    for( std::size_t i = 0; i < size; ++i )
+    {
+        double ax = std::abs( x[i] );
+        double ay = std::abs( y[i] );
+        bool steep = ay > ax;
+        double t = ( steep ? ax : ay ) / ( ( steep ? ay : ax ) + std::numeric_limits< double >::min() ); // t in [0, 1]
+        double u = t / ( 1 + std::sqrt( 1 + t * t ) );
+        double a = 2 * polynomial< A >::atan( u, u * u );
+        a = ( steep ? M_PI_2 : 0 ) + ( steep ? -a : a ); // rather than steep ? pi/2 - a : a, which the compiler would turn into a branch
+        double sign = std::copysign( 1.0, x[i] ); // as in std::atan2, -0 counts as negative
+        a = ( sign < 0 ? M_PI : 0 ) + sign * a;
+        angles[i] = std::copysign( a, y[i] );
+    }
+}
+
+void sin_cos( const double* angles, double* sines, double* cosines, std::size_t size, accuracy a )
+{
+    switch( a )
+    {
+        case fast:
+            sin_cos_< fast >( angles, sines, cosines, size );
+            break;
+        case accurate:
+            sin_cos_< accurate >( angles, sines, cosines, size );
+            break;
+        case exact:
+            for( std::size_t i = 0; i < size; ++i ) { sines[i] = std::sin( angles[i] ); cosines[i] = std::cos( angles[i] ); }
+            break;
+    }
+}
+
+void atan2( const double* y, const double* x, double* angles, std::size_t size, accuracy a )
+{
+    switch( a )
+    {
+        case fast:
+            atan2_< fast >( y, x, angles, size );
+            break;
+        case accurate:
+            atan2_< accurate >( y, x, angles, size );
+            break;
+        case exact:
+            for( std::size_t i = 0; i < size; ++i ) { angles[i] = std::atan2( y[i], x[i] ); }
+            break;
+    }
+}
+
+} } } // namespace snark { namespace math { namespace trigonometry {
@@ -0,0 +1,70 @@
+// This file is part of snark, a generic and flexible library for robotics research
+// Copyright (c) 2011 The University of Sydney
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. All advertising materials mentioning features or use of this software
+//    must display the following acknowledgement:
+//    This product includes software developed by the The University of Sydney.
+// 4. Neither the name of the The University of Sydney nor the
+//    names of its contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+//
+// NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+// GRANTED BY THIS LICENSE.  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+// HOLDERS AND CONTRIBUTORS \"AS IS\" AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+// BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+// OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+// IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef SNARK_MATH_TRIGONOMETRY_H
+#define SNARK_MATH_TRIGONOMETRY_H
+
+#include <cstddef>
+
+namespace snark { namespace math { namespace trigonometry {
+
+/// accuracy of batch trigonometric functions
+enum accuracy
+{
+    fast        /// polynomial approximation, absolute error below 1e-6
+  , accurate    /// polynomial approximation, absolute error within a few ulp
+  , exact       /// std::sin, std::cos, std::atan2
+};
+
+/// @return accuracy by name: "fast", "accurate" or "exact"
+accuracy accuracy_from_string( const char* s );
+
+/// round to nearest by adding and subtracting 1.5 * 2^52, for |x| below 2^51
+/// unlike std::floor or std::round, vectorises without -ffast-math, which in turn would fold it to x
+inline double round_to_nearest( double x )
+{
+    const double magic = 6755399441055744.0;
+    return ( x + magic ) - magic;
+}
+
+/// compute sines and cosines of given angles in batch
+/// branch-free loops over arrays, so that the compiler can vectorise them (gcc at -O2 needs -fvect-cost-model=dynamic, see math/CMakeLists.txt)
+/// approximations reduce angles by multiples of pi/2, so they are accurate for |angle| up to about 1e6
+void sin_cos( const double* angles, double* sines, double* cosines, std::size_t size, accuracy a = accurate );
+
+/// compute atan2( y, x ) in batch; result is in [-pi, pi], as in std::atan2
+void atan2( const double* y, const double* x, double* angles, std::size_t size, accuracy a = accurate );
+
+} } } // namespace snark { namespace math { namespace trigonometry {
+
+#endif // SNARK_MATH_TRIGONOMETRY_H
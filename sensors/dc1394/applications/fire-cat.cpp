@@ -90,6 +90,8 @@ int main( int argc, char** argv )
         std::string config_string; 
         std::string fields;
         unsigned int discard;
+        double statistics_period;
+        std::string statistics_file;
         unsigned int format7_width;
         unsigned int format7_height;
         unsigned int format7_size;
@@ -107,7 +109,9 @@ int main( int argc, char** argv )
             ( "no-header", "output image data only" )
             ( "width", boost::program_options::value< unsigned int >( &format7_width )->default_value( 0 ), "set width in format7 mode, default: 0 = maximum supported" )
             ( "height", boost::program_options::value< unsigned int >( &format7_height )->default_value( 0 ), "set height in format7 mode, default: 0 = maximum supported" )
-            ( "packet-size", boost::program_options::value< unsigned int >( &format7_size )->default_value( 8160 ), "set packet size in format7 mode" );
+            ( "packet-size", boost::program_options::value< unsigned int >( &format7_size )->default_value( 8160 ), "set packet size in format7 mode" )
+            ( "statistics", boost::program_options::value< double >( &statistics_period ), "output per-filter timing statistics as csv every given number of seconds, see --long-help" )
+            ( "statistics-file", boost::program_options::value< std::string >( &statistics_file ), "output statistics to file; default: stderr" );
 
         boost::program_options::variables_map vm;
         boost::program_options::store( boost::program_options::parse_command_line( argc, argv, description), vm );
@@ -134,6 +138,7 @@ int main( int argc, char** argv )
 
             if ( vm.count( "long-help" ) )
             {
+                std::cerr << snark::imaging::applications::pipeline_statistics::usage() << std::endl;
                 std::cerr << std::endl << "config file options:" << std::endl;
                 std::cerr << "\toutput-type: output image type" << std::endl;
                 std::cerr << "\tvideo-mode: dc1394 video mode" << std::endl;
@@ -236,7 +241,9 @@ int main( int argc, char** argv )
         }
 
         snark::tbb::bursty_reader< Pair > reader( boost::bind( &capture, boost::ref( camera ) ), discard );
-        snark::imaging::applications::pipeline pipeline( *serialization, filters, reader );
+        boost::scoped_ptr< snark::imaging::applications::pipeline_statistics > statistics;
+        if( vm.count( "statistics" ) ) { statistics.reset( new snark::imaging::applications::pipeline_statistics( boost::posix_time::microseconds( statistics_period * 1e6 ), statistics_file ) ); }
+        snark::imaging::applications::pipeline pipeline( *serialization, filters, reader, statistics.get() );
         pipeline.run();
         return 0;
     }
@@ -74,6 +74,7 @@ int dc1394::config::type() const
 /// @param config camera config
 dc1394::dc1394( const snark::camera::dc1394::config& config, unsigned int format7_width, unsigned int format7_height, unsigned int format7_size ):
     m_config( config ),
+    m_held( NULL ),
     m_epoch( timing::epoch ),
     m_format7_width( format7_height ),
     m_format7_height( format7_height ),
@@ -132,8 +133,6 @@ dc1394::dc1394( const snark::camera::dc1394::config& config, unsigned int format
         COMMA_THROW( comma::exception, "could not setup the camera" );
     }
 
-    m_image = cv::Mat( m_height, m_width, m_config.type() );
-    
     if ( dc1394_video_set_transmission( m_camera, DC1394_ON ) != DC1394_SUCCESS )
     {
         COMMA_THROW( comma::exception, "could not start the camera iso transmission" );
@@ -159,6 +158,7 @@ dc1394::dc1394( const snark::camera::dc1394::config& config, unsigned int format
 /// destructor
 dc1394::~dc1394()
 {
+    if( m_held ) { dc1394_capture_enqueue( m_camera, m_held ); }
     dc1394_capture_stop( m_camera );
     dc1394_video_set_transmission( m_camera, DC1394_OFF );
     dc1394_camera_free( m_camera );
@@ -167,36 +167,49 @@ dc1394::~dc1394()
 /// acquire a frame from the camera
 const cv::Mat& dc1394::read()
 {
-    
+    if( m_held ) // the image returned by the previous read() refers to it
+    {
+        dc1394_capture_enqueue( m_camera, m_held );
+        m_held = NULL;
+    }
     if ( dc1394_capture_dequeue( m_camera, DC1394_CAPTURE_POLICY_WAIT, &m_frame ) < 0 )
     {
         COMMA_THROW( comma::exception, " no frame in buffer " );
     }
     if ( dc1394_capture_is_frame_corrupt ( m_camera, m_frame ) )
     {
+        dc1394_capture_enqueue( m_camera, m_frame );
         COMMA_THROW( comma::exception, "frame corrupted" );
     }
+    //Get the time from the frame timestamp
+    m_time = m_epoch + boost::posix_time::microseconds( m_frame->timestamp );
 
     if( ( m_config.output == config::Raw ) || ( m_output_frame.color_coding == m_frame->color_coding ) )
     {
-        memcpy( m_image.data, m_frame->image, m_frame->image_bytes );
+        m_image = cv::Mat( m_height, m_width, m_config.type(), m_frame->image ); // no copy: give dma buffer back on next read
+        m_held = m_frame;
     }
     else
     {
+        std::size_t size = m_height * m_width * CV_ELEM_SIZE( m_config.type() ) + m_frame->padding_bytes; // libdc1394 reallocates smaller output buffers
+        if( m_output_frame.allocated_image_bytes < size ) // convert straight into the image
+        {
+            m_buffer.resize( size );
+            m_output_frame.image = &m_buffer[0];
+            m_output_frame.allocated_image_bytes = size;
+            m_image = cv::Mat( m_height, m_width, m_config.type(), &m_buffer[0] );
+        }
         if( dc1394_convert_frames( m_frame, &m_output_frame ) != DC1394_SUCCESS )
         {
+            dc1394_capture_enqueue( m_camera, m_frame );
             COMMA_THROW( comma::exception, "error converting frame, conversion probably not supported" );
         }
-        memcpy( m_image.data, m_output_frame.image, m_output_frame.image_bytes );
+        dc1394_capture_enqueue( m_camera, m_frame ); // release the frame
         if( m_config.output == config::BGR )
         {
             cv::cvtColor( m_image, m_image, CV_RGB2BGR );
         }
     }
-    //Get the time from the frame timestamp
-    m_time = m_epoch + boost::posix_time::microseconds( m_frame->timestamp );
-    dc1394_capture_enqueue( m_camera, m_frame ); // release the frame
-    
     return m_image;
 }
 
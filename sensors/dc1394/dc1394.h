@@ -34,6 +34,7 @@
 #ifndef SNARK_SENSORS_DC1394_H_
 #define SNARK_SENSORS_DC1394_H_
 
+#include <vector>
 #include <boost/date_time/posix_time/posix_time.hpp>
 #include <boost/optional.hpp>
 #include <dc1394/dc1394.h>
@@ -77,6 +78,9 @@ public:
     dc1394( const config& config = config(), unsigned int format7_width = 0, unsigned int format7_height = 0, unsigned int format7_size = 8160);
     ~dc1394();
 
+    /// acquire frame
+    /// @note returned image is valid only until the next read(): if no conversion is needed,
+    ///       it refers to the dma buffer directly, which is given back to the camera on the next read()
     const cv::Mat& read();
     boost::posix_time::ptime time() const { return m_time; }
     bool poll();
@@ -95,8 +99,10 @@ private:
     config m_config;
     dc1394camera_t* m_camera;
     dc1394video_frame_t* m_frame;
+    dc1394video_frame_t* m_held; /// dma frame returned by the last read(), not yet given back to the camera
     dc1394video_frame_t m_output_frame;
     cv::Mat m_image;
+    std::vector< unsigned char > m_buffer; /// converted image
     const boost::posix_time::ptime m_epoch;
     boost::posix_time::ptime m_time;
     int m_fd;
@@ -32,7 +32,6 @@
 
 #include <boost/bind.hpp>
 #include <boost/thread.hpp>
-#include <tbb/concurrent_queue.h>
 #include <tbb/pipeline.h>
 #include <tbb/task_scheduler_init.h>
 #include <comma/application/command_line_options.h>
@@ -42,18 +41,18 @@
 #include <comma/name_value/map.h>
 #include <snark/imaging/cv_mat/filters.h>
 #include <snark/imaging/cv_mat/serialization.h>
-#include <snark/tbb/queue.h>
+#include <snark/tbb/ring.h>
 #include <snark/sensors/gige/gige.h>
 #include <boost/program_options.hpp>
 
 static comma::signal_flag is_shutdown;
 static bool verbose;
 static unsigned int emptyFrameCounter = 0;
-static unsigned int discard_more_than;
 typedef std::pair< boost::posix_time::ptime, cv::Mat > Pair;
-static snark::tbb::queue< Pair > queue;
+static boost::scoped_ptr< snark::tbb::ring< Pair > > queue; // drops oldest frames, never blocks camera callback
 static boost::scoped_ptr< snark::camera::gige::callback > callback;
 static bool running = true;
+static bool copy_frames = true;
 
 static void spin_()
 {
@@ -80,35 +79,23 @@ static void on_frame_( const Pair& p ) // quick and dirty
     }
     emptyFrameCounter = 0;
     Pair q;
-    if( is_shutdown || !running ) { return queue.push( q ); } // to force read exit
+    if( is_shutdown || !running ) { queue->push( q ); return; } // to force read exit
     q.first = p.first;
-    p.second.copyTo( q.second ); // quick and dirty: full copy; todo: implement circular queue in gige::callback?
-    queue.push( q );
-    
+    if( copy_frames ) { p.second.copyTo( q.second ); } else { q.second = p.second; } // if no copy, frame is in a ring buffer of gige::callback
+    bool discarded = !queue->push( q );
     if( verbose ) { spin_(); }
-    if( discard_more_than > 0 )
-    {
-        int size = queue.size();
-        if( size > 1 )
-        {
-            int size_to_discard = size - discard_more_than;
-            Pair p;
-            for( int i = 0; i < size_to_discard; ++i ) { queue.pop( p ); } // clear() is not thread-safe
-            if( verbose && size_to_discard > 0 ) { std::cerr << "gige-cat: discarded " << size_to_discard << " frames" << std::endl; }
-        }
-    }    
+    if( verbose && discarded ) { std::cerr << "gige-cat: discarded 1 frame" << std::endl; }
 }
 
 
 static Pair read_( tbb::flow_control& flow )
 {
-    if( queue.empty() || is_shutdown || !callback->good() || !std::cout.good() || !running )
+    Pair p;
+    if( is_shutdown || !callback->good() || !std::cout.good() || !running || !queue->try_pop( p ) )
     {
         flow.stop();
         return Pair();
     }
-    Pair p;
-    queue.pop( p );
     return p;
 }
 
@@ -131,14 +118,18 @@ int main( int argc, char** argv )
         std::string fields;
         std::string setattributes;
         unsigned int discard;
+        unsigned int ring;
         boost::program_options::options_description description( "options" );
         description.add_options()
             ( "help,h", "display help message" )
             ( "set", boost::program_options::value< std::string >( &setattributes ), "set camera attributes as comma-separated name-value pairs and exit" )
             ( "id", boost::program_options::value< unsigned int >( &id )->default_value( 0 ), "camera id; default: first available camera" )
             ( "discard,d", "discard frames, if cannot keep up; same as --buffer=1" )
-            ( "buffer", boost::program_options::value< unsigned int >( &discard )->default_value( 0 ), "maximum buffer size before discarding frames" )
+            ( "buffer", boost::program_options::value< unsigned int >( &discard )->default_value( 0 ), "maximum buffer size before discarding oldest frames; 0: 1024 frames" )
+            ( "ring", boost::program_options::value< unsigned int >( &ring )->default_value( 0 ), "number of preallocated frame buffers reused in capture; should be greater than --buffer; 0: allocate each frame" )
+            ( "ring-drop", "if all ring buffers are in use, drop new frames instead of allocating" )
             ( "fields,f", boost::program_options::value< std::string >( &fields )->default_value( "t,rows,cols,type" ), "header fields, possible values: t,rows,cols,type,size" )
+            ( "align-clock", "timestamp frames by camera clock aligned to host clock, free of host reception jitter" )
             ( "list-attributes", "output current camera attributes" )
             ( "list-cameras", "list all cameras and exit" )
             ( "verbose,v", "be more verbose" )
@@ -161,7 +152,6 @@ int main( int argc, char** argv )
             std::cerr << "instead of a thread to acquire the images" << std::endl;
             std::cerr << "output to stdout as serialized cv::Mat" << std::endl;
             std::cerr << "usage: gige-capture [<options>] [<filters>]" << std::endl;
-            std::cerr << "known bug: freezes on slow consumers even with --discard, use gige-cat instead" << std::endl;
             std::cerr << description << std::endl;
             std::cerr << snark::cv_mat::filters::usage() << std::endl;
             return 1;
@@ -181,7 +171,8 @@ int main( int argc, char** argv )
         {
             discard = 1;
         }
-        discard_more_than = discard;
+        static const unsigned int default_capacity = 1024;
+        queue.reset( new snark::tbb::ring< Pair >( discard > 0 ? discard : default_capacity ) );
         snark::camera::gige::attributes_type attributes;
         if( vm.count( "set" ) )
         {
@@ -191,6 +182,7 @@ int main( int argc, char** argv )
         if( verbose ) { std::cerr << "gige-cat: connecting..." << std::endl; }
         snark::camera::gige gige( id, attributes );
         if( verbose ) { std::cerr << "gige-cat: connected to camera " << gige.id() << std::endl; }
+        if( vm.count( "align-clock" ) && !gige.align_clock() ) { COMMA_THROW( comma::exception, "camera " << gige.id() << " does not report TimeStampFrequency, cannot align clock" ); }
         if( verbose ) { std::cerr << "gige-cat: total bytes per frame: " << gige.total_bytes_per_frame() << std::endl; }
         if( !attributes.empty() ) { return 0; }
         if( vm.count( "list-attributes" ) )
@@ -230,7 +222,8 @@ int main( int argc, char** argv )
         {
             serialization.reset( new snark::cv_mat::serialization( fields, format, vm.count( "header" ) ) );
         }       
-        callback.reset( new snark::camera::gige::callback( gige, on_frame_ ) );
+        copy_frames = ring == 0;
+        callback.reset( new snark::camera::gige::callback( gige, on_frame_, ring, vm.count( "ring-drop" ) ? snark::camera::frame_ring::drop : snark::camera::frame_ring::allocate ) );
         tbb::task_scheduler_init init;
         tbb::filter_t< void, Pair > read( tbb::filter::serial_in_order, boost::bind( read_, _1 ) );
         tbb::filter_t< Pair, void > write( tbb::filter::serial_in_order, boost::bind( write_, boost::ref( *serialization), _1 ) );
@@ -254,10 +247,11 @@ int main( int argc, char** argv )
         while( !is_shutdown && running )
         {
             tbb::parallel_pipeline( init.default_num_threads(), imageFilters & write );
-            queue.wait();
+            queue->wait();
         }
         
         if( is_shutdown && verbose ) { std::cerr << "gige-cat: caught signal" << std::endl; }
+        if( verbose && callback->missed() > 0 ) { std::cerr << "gige-cat: all ring buffers were in use for " << callback->missed() << " frame(s)" << std::endl; }
         return 0;
     }
     catch( std::exception& ex )
@@ -51,6 +51,8 @@ int main( int argc, char** argv )
         unsigned int id;
         std::string setattributes;
         unsigned int discard;
+        double statistics_period;
+        std::string statistics_file;
         boost::program_options::options_description description( "options" );
         description.add_options()
             ( "help,h", "display help message" )
@@ -60,10 +62,13 @@ int main( int argc, char** argv )
             ( "discard", "discard frames, if cannot keep up; same as --buffer=1" )
             ( "buffer", boost::program_options::value< unsigned int >( &discard )->default_value( 0 ), "maximum buffer size before discarding frames, default: unlimited" )
             ( "fields,f", boost::program_options::value< std::string >( &fields )->default_value( "t,rows,cols,type" ), "header fields, possible values: t,rows,cols,type,size" )
+            ( "align-clock", "timestamp frames by camera clock aligned to host clock, free of host reception jitter" )
             ( "list-attributes", "output current camera attributes" )
             ( "list-cameras", "list all cameras and exit" )
             ( "header", "output header only" )
             ( "no-header", "output image data only" )
+            ( "statistics", boost::program_options::value< double >( &statistics_period ), "output per-filter timing statistics as csv every given number of seconds" )
+            ( "statistics-file", boost::program_options::value< std::string >( &statistics_file ), "output statistics to file; default: stderr" )
             ( "verbose,v", "be more verbose" );
 
         boost::program_options::variables_map vm;
@@ -78,6 +83,7 @@ int main( int argc, char** argv )
             std::cerr << "output header format: fields: t,cols,rows,type; binary: t,3ui\n" << std::endl;
             std::cerr << description << std::endl;
             std::cerr << snark::cv_mat::filters::usage() << std::endl;
+            std::cerr << snark::imaging::applications::pipeline_statistics::usage() << std::endl;
             return 1;
         }
         if( vm.count( "header" ) && vm.count( "no-header" ) ) { COMMA_THROW( comma::exception, "--header and --no-header are mutually exclusive" ); }
@@ -107,6 +113,7 @@ int main( int argc, char** argv )
         if( verbose ) { std::cerr << "gige-cat: connecting..." << std::endl; }
         snark::camera::gige camera( id, attributes );
         if( verbose ) { std::cerr << "gige-cat: connected to camera " << camera.id() << std::endl; }
+        if( vm.count( "align-clock" ) && !camera.align_clock() ) { COMMA_THROW( comma::exception, "camera " << camera.id() << " does not report TimeStampFrequency, cannot align clock" ); }
         if( verbose ) { std::cerr << "gige-cat: total bytes per frame: " << camera.total_bytes_per_frame() << std::endl; }
         if( vm.count( "set-and-exit" ) ) { return 0; }
         if( vm.count( "list-attributes" ) )
@@ -142,7 +149,9 @@ int main( int argc, char** argv )
             serialization.reset( new snark::cv_mat::serialization( fields, format, vm.count( "header" ) ) );
         }
         snark::tbb::bursty_reader< Pair > reader( boost::bind( &capture, boost::ref( camera ) ), discard );
-        snark::imaging::applications::pipeline pipeline( *serialization, filters, reader );
+        boost::scoped_ptr< snark::imaging::applications::pipeline_statistics > statistics;
+        if( vm.count( "statistics" ) ) { statistics.reset( new snark::imaging::applications::pipeline_statistics( boost::posix_time::microseconds( statistics_period * 1e6 ), statistics_file ) ); }
+        snark::imaging::applications::pipeline pipeline( *serialization, filters, reader, statistics.get() );
         pipeline.run();
         return 0;
     }
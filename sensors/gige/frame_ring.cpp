@@ -0,0 +1,72 @@
+// This file is part of snark, a generic and flexible library for robotics research
+// Copyright (c) 2011 The University of Sydney
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. All advertising materials mentioning features or use of this software
+//    must display the following acknowledgement:
+//    This product includes software developed by the The University of Sydney.
+// 4. Neither the name of the The University of Sydney nor the
+//    names of its contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+//
+// NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+// GRANTED BY THIS LICENSE.  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+// HOLDERS AND CONTRIBUTORS \"AS IS\" AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+// BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+// OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+// IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <comma/base/exception.h>
+#include "./frame_ring.h"
+
+namespace snark{ namespace camera{
+
+static bool is_free_( const cv::Mat& m ) // true, if only the ring refers to the buffer
+{
+    #if CV_MAJOR_VERSION >= 3
+    return !m.u || m.u->refcount == 1;
+    #else
+    return !m.refcount || *m.refcount == 1;
+    #endif
+}
+
+frame_ring::frame_ring( unsigned int size, frame_ring::policy p )
+    : buffers_( size )
+    , next_( 0 )
+    , policy_( p )
+    , missed_( 0 )
+{
+    if( size == 0 ) { COMMA_THROW( comma::exception, "expected positive number of buffers, got 0" ); }
+}
+
+cv::Mat frame_ring::copy( const cv::Mat& frame )
+{
+    for( std::size_t i = 0; i < buffers_.size(); ++i, next_ = ( next_ + 1 ) % buffers_.size() )
+    {
+        cv::Mat& buffer = buffers_[ next_ ];
+        if( !is_free_( buffer ) ) { continue; }
+        buffer.create( frame.rows, frame.cols, frame.type() ); // allocates only first time or if frame size changes
+        frame.copyTo( buffer );
+        next_ = ( next_ + 1 ) % buffers_.size();
+        return buffer;
+    }
+    ++missed_;
+    return policy_ == allocate ? frame.clone() : cv::Mat();
+}
+
+} } // namespace snark{ namespace camera{
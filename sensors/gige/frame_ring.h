@@ -0,0 +1,80 @@
+// This file is part of snark, a generic and flexible library for robotics research
+// Copyright (c) 2011 The University of Sydney
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. All advertising materials mentioning features or use of this software
+//    must display the following acknowledgement:
+//    This product includes software developed by the The University of Sydney.
+// 4. Neither the name of the The University of Sydney nor the
+//    names of its contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+//
+// NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+// GRANTED BY THIS LICENSE.  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+// HOLDERS AND CONTRIBUTORS \"AS IS\" AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+// BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+// OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+// IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef SNARK_SENSORS_GIGE_FRAME_RING_H_
+#define SNARK_SENSORS_GIGE_FRAME_RING_H_
+
+#include <vector>
+#include <opencv2/core/core.hpp>
+#include <comma/base/types.h>
+
+namespace snark{ namespace camera{
+
+/// circular set of preallocated frame buffers
+///
+/// copy() copies a frame into the next free buffer and returns a cv::Mat sharing it;
+/// a buffer is free again once all cv::Mat instances referring to it outside of the ring
+/// have been released, so in a steady state no frames are allocated
+///
+/// @note copy() is meant to be called from a single (capture) thread; returned images
+///       may be released in any thread
+class frame_ring
+{
+    public:
+        /// what to do, if all buffers are still in use
+        enum policy { allocate, /// return a newly allocated copy
+                      drop /// drop the frame, return empty image
+                    };
+
+        /// constructor
+        frame_ring( unsigned int size, policy p = allocate );
+
+        /// copy frame into the next free buffer and return the buffer
+        cv::Mat copy( const cv::Mat& frame );
+
+        /// number of buffers
+        std::size_t size() const { return buffers_.size(); }
+
+        /// number of frames, for which all buffers were in use (dropped or allocated, depending on policy)
+        comma::uint64 missed() const { return missed_; }
+
+    private:
+        std::vector< cv::Mat > buffers_;
+        std::size_t next_;
+        policy policy_;
+        comma::uint64 missed_;
+};
+
+} } // namespace snark{ namespace camera{
+
+#endif // SNARK_SENSORS_GIGE_FRAME_RING_H_
@@ -33,8 +33,10 @@
 
 #include <boost/lexical_cast.hpp>
 #include <boost/optional.hpp>
+#include <boost/scoped_ptr.hpp>
 #include <boost/thread.hpp>
 #include <comma/base/exception.h>
+#include <snark/timing/clock_alignment.h>
 #include "./gige.h"
 
 static void PVDECL pv_callback_( tPvFrame *frame );
@@ -190,7 +192,8 @@ class gige::impl
     public:
         impl( unsigned int id, const attributes_type& attributes ) :
             started_( false ),
-            timeOut_( 1000 )
+            timeOut_( 1000 ),
+            tick_frequency_( 0 )
         {
             initialize_();
             static const boost::posix_time::time_duration timeout = boost::posix_time::seconds( 5 ); // quick and dirty; make configurable?
@@ -290,7 +293,7 @@ class gige::impl
                             {
                                 result = frame_.Status;
                             }
-                            pair.first = boost::posix_time::microsec_clock::universal_time();
+                            pair.first = timestamp( frame_, boost::posix_time::microsec_clock::universal_time() );
                         }
                     }
                 }
@@ -317,6 +320,23 @@ class gige::impl
             COMMA_THROW( comma::exception, "got lots of missing frames or timeouts" << std::endl << std::endl << "it is likely that MTU size on your machine is less than packet size" << std::endl << "check PacketSize attribute (gige-cat --list-attributes)" << std::endl << "set packet size (e.g. gige-cat --set=PacketSize=1500)" << std::endl << "or increase MTU size on your machine" );
         }
         
+        bool align_clock()
+        {
+            tPvErr result = PvAttrUint32Get( handle_, "TimeStampFrequency", &tick_frequency_ );
+            if( result != ePvErrSuccess || tick_frequency_ == 0 ) { return false; }
+            alignment_.reset( new timing::clock_alignment );
+            return true;
+        }
+
+        /// frame time from camera ticks aligned to host time, if clock alignment is on; otherwise host time
+        boost::posix_time::ptime timestamp( const tPvFrame& frame, const boost::posix_time::ptime& host )
+        {
+            if( !alignment_ ) { return host; }
+            comma::uint64 ticks = ( comma::uint64( frame.TimestampHi ) << 32 ) | frame.TimestampLo;
+            comma::int64 microseconds = ticks / tick_frequency_ * 1000000 + ( ticks % tick_frequency_ ) * 1000000 / tick_frequency_;
+            return alignment_->adjusted( timing::timestamp( microseconds ), timing::timestamp( host ) ).to_ptime();
+        }
+
         const tPvHandle& handle() const { return handle_; }
         
         tPvHandle& handle() { return handle_; }
@@ -353,6 +373,8 @@ class gige::impl
         unsigned long total_bytes_per_frame_;
         bool started_;
         unsigned int timeOut_; // milliseconds
+        tPvUint32 tick_frequency_;
+        boost::scoped_ptr< timing::clock_alignment > alignment_;
         static void initialize_() // quick and dirty
         {
             static tPvErr result = PvInitialize(); // should it be a singleton?
@@ -365,13 +387,15 @@ class gige::callback::impl
     public:
         typedef boost::function< void ( const std::pair< boost::posix_time::ptime, cv::Mat >& ) > OnFrame;
         
-        impl( gige& gige, OnFrame on_frame )
+        impl( gige& gige, OnFrame on_frame, unsigned int buffers, frame_ring::policy policy )
             : on_frame( on_frame )
+            , camera( *gige.pimpl_ )
             , handle( gige.pimpl_->handle() )
             , frame( gige.pimpl_->frame_ )
             , good( true )
             , is_shutdown( false )
         {
+            if( buffers > 0 ) { ring.reset( new frame_ring( buffers, policy ) ); }
             tPvErr result;
             PvCaptureQueueClear( handle );
             frame.Context[0] = this;
@@ -392,10 +416,12 @@ class gige::callback::impl
         }
 
         OnFrame on_frame;
+        gige::impl& camera;
         tPvHandle& handle;
         tPvFrame& frame;
         bool good;
         bool is_shutdown;
+        boost::scoped_ptr< frame_ring > ring;
 };
 
 } } // namespace snark{ namespace camera{
@@ -405,8 +431,10 @@ static void PVDECL pv_callback_( tPvFrame *frame )
     snark::camera::gige::callback::impl* c = reinterpret_cast< snark::camera::gige::callback::impl* >( frame->Context[0] );
     if( c->is_shutdown ) { return; }
     std::pair< boost::posix_time::ptime, cv::Mat > m( boost::posix_time::microsec_clock::universal_time(), cv::Mat() );
-    if( frame ) { m.second = snark::camera::pv_as_cvmat_( *frame ); }
-    c->on_frame( m );
+    if( frame ) { m.first = c->camera.timestamp( *frame, m.first ); m.second = snark::camera::pv_as_cvmat_( *frame ); }
+    bool dropped = false;
+    if( c->ring && !m.second.empty() ) { m.second = c->ring->copy( m.second ); dropped = m.second.empty(); }
+    if( !dropped ) { c->on_frame( m ); }
     tPvErr result = PvCaptureQueueFrame( c->handle, &c->frame, pv_callback_ );
     if( result != ePvErrSuccess ) { c->good = false; }
 }
@@ -419,6 +447,8 @@ gige::~gige() { delete pimpl_; }
 
 std::pair< boost::posix_time::ptime, cv::Mat > gige::read() { return pimpl_->read(); }
 
+bool gige::align_clock() { return pimpl_->align_clock(); }
+
 void gige::close() { pimpl_->close(); }
 
 std::vector< tPvCameraInfo > gige::list_cameras() { return gige::impl::list_cameras(); }
@@ -429,8 +459,8 @@ unsigned long gige::total_bytes_per_frame() const { return pimpl_->total_bytes_p
 
 gige::attributes_type gige::attributes() const { return pv_attributes_( pimpl_->handle() ); }
 
-gige::callback::callback( gige& gige, boost::function< void ( std::pair< boost::posix_time::ptime, cv::Mat > ) > on_frame )
-    : pimpl_( new callback::impl( gige, on_frame ) )
+gige::callback::callback( gige& gige, boost::function< void ( std::pair< boost::posix_time::ptime, cv::Mat > ) > on_frame, unsigned int buffers, frame_ring::policy policy )
+    : pimpl_( new callback::impl( gige, on_frame, buffers, policy ) )
 {
 }
 
@@ -438,4 +468,6 @@ gige::callback::~callback() { delete pimpl_; }
 
 bool gige::callback::good() const { return pimpl_->good; }
 
+comma::uint64 gige::callback::missed() const { return pimpl_->ring ? pimpl_->ring->missed() : 0; }
+
 } } // namespace snark{ namespace camera{
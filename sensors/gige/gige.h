@@ -39,6 +39,8 @@
 #include <boost/function.hpp>
 
 #include <opencv2/core/core.hpp>
+#include <comma/base/types.h>
+#include <snark/sensors/gige/frame_ring.h>
 
 
 namespace snark{ namespace camera{
@@ -62,6 +64,11 @@ class gige
         /// get timestamped frame
         std::pair< boost::posix_time::ptime, cv::Mat > read();
 
+        /// timestamp frames by camera clock aligned to host clock (see timing::clock_alignment)
+        /// instead of host reception time, which jitters with system load
+        /// @return false, if camera does not report its clock frequency
+        bool align_clock();
+
         /// return camera id
         unsigned int id() const;
 
@@ -79,7 +86,11 @@ class gige
         {
             public:
                 /// constructor: start capture, call callback on frame update
-                callback( gige& gige, boost::function< void ( std::pair< boost::posix_time::ptime, cv::Mat > ) > on_frame );
+                /// @param buffers if not 0, frames are copied into a ring of preallocated buffers (see frame_ring)
+                ///                and passed to on_frame sharing the buffer; otherwise the frame passed to on_frame
+                ///                refers to the camera buffer, valid only until on_frame returns
+                /// @param policy what to do, if all buffers are in use; if frame is dropped, on_frame is not called
+                callback( gige& gige, boost::function< void ( std::pair< boost::posix_time::ptime, cv::Mat > ) > on_frame, unsigned int buffers = 0, frame_ring::policy policy = frame_ring::allocate );
 
                 /// destructor: stop capture
                 ~callback();
@@ -89,6 +100,9 @@ class gige
                 
                 /// return true, if callback status is ok
                 bool good() const;
+
+                /// number of frames, for which all ring buffers were in use
+                comma::uint64 missed() const;
                 
             private:
                 friend class gige;
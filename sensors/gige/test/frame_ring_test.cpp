@@ -0,0 +1,211 @@
+// This file is part of snark, a generic and flexible library for robotics research
+// Copyright (c) 2011 The University of Sydney
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. All advertising materials mentioning features or use of this software
+//    must display the following acknowledgement:
+//    This product includes software developed by the The University of Sydney.
+// 4. Neither the name of the The University of Sydney nor the
+//    names of its contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+//
+// NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+// GRANTED BY THIS LICENSE.  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+// HOLDERS AND CONTRIBUTORS \"AS IS\" AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+// BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+// OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+// IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <deque>
+#include <set>
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+#include <gtest/gtest.h>
+#include <snark/sensors/gige/frame_ring.h>
+
+namespace snark { namespace camera {
+
+/// simulated camera: keeps writing frames into the same buffer, as pvapi does
+class simulated_camera
+{
+    public:
+        simulated_camera( int rows = 48, int cols = 64, int type = CV_8UC1 ) : buffer_( rows, cols, type ), count_( 0 ) {}
+
+        /// return frame referring to camera buffer, filled with frame number
+        cv::Mat capture() { buffer_.setTo( cv::Scalar( count_++ % 256 ) ); return buffer_; }
+
+        unsigned int count() const { return count_; }
+
+    private:
+        cv::Mat buffer_;
+        unsigned int count_;
+};
+
+static bool filled_with_( const cv::Mat& m, unsigned char value )
+{
+    for( int i = 0; i < m.rows; ++i ) { for( int j = 0; j < m.cols; ++j ) { if( m.at< unsigned char >( i, j ) != value ) { return false; } } }
+    return true;
+}
+
+TEST( frame_ring, reuse )
+{
+    simulated_camera camera;
+    frame_ring ring( 4 );
+    std::set< const unsigned char* > buffers;
+    for( unsigned int i = 0; i < 100; ++i )
+    {
+        cv::Mat frame = ring.copy( camera.capture() );
+        EXPECT_TRUE( filled_with_( frame, i ) );
+        buffers.insert( frame.data );
+    }
+    EXPECT_EQ( 4u, buffers.size() );
+    EXPECT_EQ( 0u, ring.missed() );
+}
+
+TEST( frame_ring, copies_are_independent_of_camera_buffer )
+{
+    simulated_camera camera;
+    frame_ring ring( 4 );
+    cv::Mat first = ring.copy( camera.capture() );
+    cv::Mat second = ring.copy( camera.capture() );
+    camera.capture();
+    EXPECT_NE( first.data, second.data );
+    EXPECT_TRUE( filled_with_( first, 0 ) );
+    EXPECT_TRUE( filled_with_( second, 1 ) );
+}
+
+TEST( frame_ring, held_buffers_are_not_reused )
+{
+    simulated_camera camera;
+    frame_ring ring( 3, frame_ring::drop );
+    std::vector< cv::Mat > held;
+    for( unsigned int i = 0; i < 3; ++i ) { held.push_back( ring.copy( camera.capture() ) ); }
+    EXPECT_TRUE( ring.copy( camera.capture() ).empty() );
+    EXPECT_EQ( 1u, ring.missed() );
+    for( unsigned int i = 0; i < 3; ++i ) { EXPECT_TRUE( filled_with_( held[i], i ) ); }
+    const unsigned char* released = held[1].data;
+    held[1].release();
+    cv::Mat frame = ring.copy( camera.capture() );
+    EXPECT_EQ( released, frame.data );
+    EXPECT_TRUE( filled_with_( frame, 4 ) );
+    EXPECT_TRUE( filled_with_( held[0], 0 ) );
+    EXPECT_TRUE( filled_with_( held[2], 2 ) );
+}
+
+TEST( frame_ring, allocate_if_all_in_use )
+{
+    simulated_camera camera;
+    frame_ring ring( 2, frame_ring::allocate );
+    cv::Mat a = ring.copy( camera.capture() );
+    cv::Mat b = ring.copy( camera.capture() );
+    cv::Mat c = ring.copy( camera.capture() );
+    EXPECT_FALSE( c.empty() );
+    EXPECT_NE( a.data, c.data );
+    EXPECT_NE( b.data, c.data );
+    EXPECT_TRUE( filled_with_( c, 2 ) );
+    EXPECT_EQ( 1u, ring.missed() );
+}
+
+TEST( frame_ring, frame_size_change )
+{
+    simulated_camera small( 10, 20 );
+    simulated_camera large( 30, 40, CV_8UC3 );
+    frame_ring ring( 2 );
+    cv::Mat m = ring.copy( small.capture() );
+    EXPECT_EQ( 10, m.rows );
+    m = ring.copy( large.capture() );
+    EXPECT_EQ( 30, m.rows );
+    EXPECT_EQ( 40, m.cols );
+    EXPECT_EQ( CV_8UC3, m.type() );
+}
+
+struct drop_oldest_queue // as in gige-callback: bounded queue dropping oldest frames
+{
+    std::deque< std::pair< unsigned int, cv::Mat > > frames;
+    boost::mutex mutex;
+    unsigned int capacity;
+    unsigned int dropped;
+    bool done;
+
+    drop_oldest_queue( unsigned int capacity ) : capacity( capacity ), dropped( 0 ), done( false ) {}
+
+    void push( unsigned int n, const cv::Mat& m )
+    {
+        boost::mutex::scoped_lock lock( mutex );
+        frames.push_back( std::make_pair( n, m ) );
+        while( frames.size() > capacity ) { frames.pop_front(); ++dropped; }
+    }
+
+    bool pop( std::pair< unsigned int, cv::Mat >& p )
+    {
+        boost::mutex::scoped_lock lock( mutex );
+        if( frames.empty() ) { return false; }
+        p = frames.front();
+        frames.pop_front();
+        return true;
+    }
+
+    void finish() { boost::mutex::scoped_lock lock( mutex ); done = true; }
+
+    bool finished() { boost::mutex::scoped_lock lock( mutex ); return done && frames.empty(); }
+};
+
+static void consume_( drop_oldest_queue& queue, unsigned int& received, unsigned int& corrupted )
+{
+    while( true )
+    {
+        std::pair< unsigned int, cv::Mat > p;
+        if( !queue.pop( p ) )
+        {
+            if( queue.finished() ) { return; }
+            boost::this_thread::yield();
+            continue;
+        }
+        ++received;
+        boost::this_thread::yield(); // pretend to process the frame, still holding it
+        if( !filled_with_( p.second, p.first % 256 ) ) { ++corrupted; }
+    }
+}
+
+TEST( frame_ring, simulated_capture )
+{
+    simulated_camera camera;
+    frame_ring ring( 8, frame_ring::drop );
+    drop_oldest_queue queue( 4 ); // ring size greater than queue size + frames in processing
+    unsigned int received = 0;
+    unsigned int corrupted = 0;
+    boost::thread consumer( boost::bind( &consume_, boost::ref( queue ), boost::ref( received ), boost::ref( corrupted ) ) );
+    std::set< const unsigned char* > buffers;
+    unsigned int delivered = 0;
+    for( unsigned int i = 0; i < 2000; ++i )
+    {
+        cv::Mat frame = ring.copy( camera.capture() );
+        if( frame.empty() ) { continue; }
+        buffers.insert( frame.data );
+        queue.push( i, frame );
+        ++delivered;
+    }
+    queue.finish();
+    consumer.join();
+    EXPECT_EQ( 0u, corrupted );
+    EXPECT_EQ( 0u, ring.missed() );
+    EXPECT_EQ( delivered, received + queue.dropped );
+    EXPECT_LE( buffers.size(), 8u );
+}
+
+} } // namespace snark { namespace camera {
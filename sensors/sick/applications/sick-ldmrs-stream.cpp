@@ -39,6 +39,7 @@
 #include <comma/base/exception.h>
 #include <comma/name_value/map.h>
 #include <comma/string/string.h>
+#include <snark/timing/clock_alignment.h>
 #include <snark/timing/ntp.h>
 #include <snark/sensors/sick/protocol.h>
 
@@ -70,6 +71,9 @@ static void usage()
     std::cerr << "            port=<port>: set tcp port" << std::endl;
     std::cerr << "    --start: start pumping laser scan data" << std::endl;
     std::cerr << "    --stop: stop pumping laser scan data" << std::endl;
+    std::cerr << "    --align-clock: set laser time once and fit laser clock to host clock, instead" << std::endl;
+    std::cerr << "                   of setting laser time every minute; scan times in the output" << std::endl;
+    std::cerr << "                   are aligned to host time without steps and reception jitter" << std::endl;
     std::cerr << "    --verbose,-v: more output to stderr" << std::endl;
     std::cerr << std::endl;
     std::cerr << "author:" << std::endl;
@@ -105,6 +109,15 @@ static void update_timestamp( bool force = false )
     if( verbose ) { std::cerr << "sick-ldmrs-stream: set time to " << boost::posix_time::to_iso_string( now ) << std::endl; }
 }
 
+static boost::posix_time::ptime get_time( const sick::ldmrs::little_endian_timestamp& t ) { return snark::timing::from_ntp_time( t.seconds(), t.fractions() ); }
+
+static void set_time( sick::ldmrs::little_endian_timestamp& t, const boost::posix_time::ptime& time )
+{
+    std::pair< comma::uint32, comma::uint32 > ntp = snark::timing::to_ntp_time( time );
+    t.seconds = ntp.first;
+    t.fractions = ntp.second;
+}
+
 int main( int ac, char** av )
 {
     boost::scoped_ptr< boost::asio::ip::tcp::iostream > stream;
@@ -113,7 +126,7 @@ int main( int ac, char** av )
         comma::command_line_options options( ac, av );
         if( options.exists( "--help,-h" ) ) { usage(); }
         verbose = options.exists( "--verbose,-v" );
-        std::vector< std::string > v = options.unnamed( "--help,-h,--get-status,--reset,--reset-dsp,--start,--stop,--verbose,-v", "--get,--set" );
+        std::vector< std::string > v = options.unnamed( "--help,-h,--get-status,--reset,--reset-dsp,--start,--stop,--align-clock,--verbose,-v", "--get,--set" );
         std::vector< std::string > a = comma::split( ( v.empty() ? std::string( "192.168.0.1:12002" ) : v[0] ), ':' );
         if( a.size() != 2 ) { std::cerr << "sick-ldmrs-stream: expected address, got \"" << v[0] << "\"" << std::endl; usage(); }
         std::string address = a[0];
@@ -218,13 +231,16 @@ int main( int ac, char** av )
             if( !protocol->write( sick::ldmrs::commands::start() ).ok() ) { COMMA_THROW( comma::exception, "failed to start scanning" ); }
             if( verbose ) { std::cerr << "sick-ldmrs-stream: started scanning" << std::endl; }
             bool first = true;
+            boost::scoped_ptr< snark::timing::clock_alignment > alignment;
+            if( options.exists( "--align-clock" ) ) { alignment.reset( new snark::timing::clock_alignment ); }
+            std::vector< char > buffer;
             comma::signal_flag is_shutdown;
 #ifdef WIN32
             _setmode( _fileno( stdout ), _O_BINARY ); 
 #endif
             while( !is_shutdown )
             {
-                update_timestamp();
+                if( !alignment ) { update_timestamp(); } // setting laser time would step the aligned clock
                 clear_fault();
                 const sick::ldmrs::scan_packet* scan;
                 try { scan = protocol->readscan(); }
@@ -232,13 +248,28 @@ int main( int ac, char** av )
                 if( scan == NULL ) { break; }
                 if( verbose && first ) { std::cerr << "sick-ldmrs-stream: got first scan" << std::endl; first = false; }
                 if( !scan->packet_header.valid() ) { COMMA_THROW( comma::exception, "invalid scan" ); }
-                std::cout.write( scan->data(), sick::ldmrs::header::size + scan->packet_header.payload_size() );
+                const char* data = scan->data();
+                std::size_t size = sick::ldmrs::header::size + scan->packet_header.payload_size();
+                if( alignment )
+                {
+                    boost::posix_time::ptime received = boost::posix_time::microsec_clock::universal_time();
+                    buffer.assign( data, data + size );
+                    sick::ldmrs::scan::header& scan_header = reinterpret_cast< sick::ldmrs::scan_packet& >( buffer[0] ).packet_scan.scan_header;
+                    boost::posix_time::ptime start = get_time( scan_header.start );
+                    boost::posix_time::ptime finish = get_time( scan_header.finish );
+                    alignment->update( finish, received ); // scan is sent once finished
+                    set_time( scan_header.start, alignment->to_host( start ).to_ptime() );
+                    set_time( scan_header.finish, alignment->to_host( finish ).to_ptime() );
+                    data = &buffer[0];
+                }
+                std::cout.write( data, size );
                 if( verbose && ( scan->packet_scan.scan_header.measurement_number() % 10 == 0 ) )
                 {
                     std::cerr << "sick-ldmrs-stream: got " << scan->packet_scan.scan_header.measurement_number() << " scans              \r";
                 }
             }
             if( is_shutdown ) { std::cerr << "sick-ldmrs-stream: caught signal" << std::endl; }
+            if( alignment && verbose ) { std::cerr << "sick-ldmrs-stream: clock offset " << alignment->offset() << ", drift " << alignment->drift() << ", " << alignment->outliers() << " outlier(s), " << alignment->restarts() << " restart(s)" << std::endl; }
         }
         if( ok ) { if( verbose ) { std::cerr << "sick-ldmrs-stream: done" << std::endl; } }
         else { std::cerr << "sick-ldmrs-stream: failed" << std::endl; }
@@ -34,7 +34,10 @@
 #ifndef SNARK_TBB_BURSTY_READER_H_
 #define SNARK_TBB_BURSTY_READER_H_
 
-#include <snark/tbb/queue.h>
+#include <comma/base/types.h>
+#include <snark/tbb/ring.h>
+#include <boost/bind.hpp>
+#include <boost/scoped_ptr.hpp>
 #include <boost/thread.hpp>
 #include <tbb/pipeline.h>
 
@@ -63,26 +66,37 @@ public:
     void join();
     ::tbb::filter_t< void, T >& filter() { return m_read_filter; }
 
+    /// current number of items waiting in the input queue
+    unsigned int size() const { return m_queue.size(); }
+
+    /// total number of items discarded so far because the queue exceeded its size
+    comma::uint64 discarded() const { return m_queue.dropped(); }
+
+    /// input queue capacity, if neither size nor capacity given
+    static const unsigned int default_capacity = 1024;
+
 private:
     T read( ::tbb::flow_control& flow );
     void push();
     void push_thread();
 
-    queue< T > m_queue;
-    unsigned int m_size;
+    ring< T > m_queue;
     bool m_running;
     boost::scoped_ptr< boost::thread > m_thread;
     boost::function0< T > m_read;
     ::tbb::filter_t< void, T > m_read_filter;
 };
 
+template< typename T >
+const unsigned int bursty_reader< T >::default_capacity;
 
 /// constructor
 /// @param read the user-provided read functor that outputs the data
-/// @param size maximum input queue size before discarding data, 0 means infinite
+/// @param size maximum input queue size before discarding the oldest data, 0 means no discarding:
+///             the reader thread blocks once default_capacity items are waiting
 template< typename T >
 bursty_reader< T >::bursty_reader( boost::function0< T > read, unsigned int size ):
-    m_size( size ),
+    m_queue( size > 0 ? size : default_capacity, size > 0 ? ring< T >::drop_oldest : ring< T >::block ),
     m_running( true ),
     m_read( read ),
     m_read_filter( ::tbb::filter::serial_in_order, boost::bind( &bursty_reader< T >::read, this, _1 ) )
@@ -92,12 +106,11 @@ bursty_reader< T >::bursty_reader( boost::function0< T > read, unsigned int size
 
 /// constructor
 /// @param read the user-provided read functor that outputs the data
-/// @param size maximum input queue size before discarding data, 0 means infinite
-/// @param capacity maximum input queue size before the reader thread blocks
+/// @param size maximum input queue size before discarding the oldest data, 0 means no discarding
+/// @param capacity maximum input queue size before the reader thread blocks, if size is 0
 template< typename T >
 bursty_reader< T >::bursty_reader( boost::function0< T > read, unsigned int size, unsigned int capacity ):
-    m_queue( capacity ),
-    m_size( size ),
+    m_queue( size > 0 ? size : ( capacity > 0 ? capacity : default_capacity ), size > 0 ? ring< T >::drop_oldest : ring< T >::block ),
     m_running( true ),
     m_read( read ),
     m_read_filter( ::tbb::filter::serial_in_order, boost::bind( &bursty_reader< T >::read, this, _1 ) )
@@ -147,28 +160,8 @@ void bursty_reader< T >::join()
 template< typename T >
 T bursty_reader< T >::read( ::tbb::flow_control& flow )
 {
-    if( m_queue.empty() )
-    {
-        flow.stop();
-        return T();
-    }
-    if( m_size > 0 )
-    {
-        T t;
-        unsigned int n = 0;
-        while( m_queue.size() > m_size )
-        {
-            m_queue.pop( t );
-            n++;
-        }
-//         if( n > 0 ) TODO how to warn the user that data is discarded ?
-//         {
-//             std::cerr << "warning: discarded " << n << " frame(s)" << std::endl;
-//         }
-    }
     T t;
-    m_queue.pop( t );
-    if( !bursty_reader_traits< T >::valid( t ) )
+    if( !m_queue.try_pop( t ) || !bursty_reader_traits< T >::valid( t ) )
     {
         flow.stop();
         return T();
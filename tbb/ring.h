@@ -0,0 +1,208 @@
+// This file is part of snark, a generic and flexible library for robotics research
+// Copyright (c) 2011 The University of Sydney
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. All advertising materials mentioning features or use of this software
+//    must display the following acknowledgement:
+//    This product includes software developed by the The University of Sydney.
+// 4. Neither the name of the The University of Sydney nor the
+//    names of its contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+//
+// NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+// GRANTED BY THIS LICENSE.  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+// HOLDERS AND CONTRIBUTORS \"AS IS\" AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+// BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+// OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+// IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef SNARK_TBB_RING_H_
+#define SNARK_TBB_RING_H_
+
+#include <vector>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <comma/base/exception.h>
+#include <comma/base/types.h>
+#include <tbb/atomic.h>
+
+namespace snark{ namespace tbb{
+
+/// lock-free bounded ring for a single producer and multiple consumers
+///
+/// each slot carries a sequence number telling whether it is free or holds
+/// an item, so push and try_pop never lock; consumers blocked in wait() and,
+/// with block policy, a producer blocked on full ring are woken by condition variable,
+/// which is touched only if someone is actually waiting
+///
+/// @note push() must be called from a single thread; try_pop() and wait() from any
+template < typename T >
+class ring
+{
+    public:
+        /// what to do, if ring is full
+        enum policy { drop_oldest, /// discard the oldest item to make room
+                      block /// wait until a consumer pops an item
+                    };
+
+        /// constructor
+        ring( std::size_t capacity, policy p = drop_oldest );
+
+        /// push item
+        /// @return false, if oldest item was dropped to make room or, with block policy, ring was shut down
+        bool push( const T& t );
+
+        /// pop oldest item
+        /// @return false, if ring is empty
+        bool try_pop( T& t );
+
+        /// block until ring is not empty or shut down
+        void wait();
+
+        /// wake up all waiting threads; a producer blocked on full ring fails to push
+        void shutdown();
+
+        /// number of items in the ring, exact only if no push or pop is in progress
+        std::size_t size() const;
+
+        bool empty() const { return size() == 0; }
+
+        std::size_t capacity() const { return slots_.size(); }
+
+        /// number of items dropped so far
+        comma::uint64 dropped() const { return dropped_; }
+
+    private:
+        struct slot
+        {
+            ::tbb::atomic< comma::uint64 > sequence; // 2 * position, if slot is free for position; 2 * position + 1, if item at position is ready
+            T value;
+        };
+        std::vector< slot > slots_;
+        policy policy_;
+        comma::uint64 tail_; // next position to push, producer only
+        ::tbb::atomic< comma::uint64 > head_; // next position to pop
+        ::tbb::atomic< comma::uint64 > published_; // tail as seen by consumers
+        ::tbb::atomic< comma::uint64 > dropped_;
+        ::tbb::atomic< unsigned int > waiting_;
+        ::tbb::atomic< bool > producer_waiting_;
+        ::tbb::atomic< bool > shutdown_;
+        boost::mutex mutex_;
+        boost::condition_variable condition_;
+
+        void notify_();
+};
+
+template < typename T >
+ring< T >::ring( std::size_t capacity, policy p ) : slots_( capacity ), policy_( p ), tail_( 0 )
+{
+    if( capacity == 0 ) { COMMA_THROW( comma::exception, "expected positive ring capacity, got 0" ); }
+    for( std::size_t i = 0; i < capacity; ++i ) { slots_[i].sequence = 2 * i; }
+    head_ = 0;
+    published_ = 0;
+    dropped_ = 0;
+    waiting_ = 0;
+    producer_waiting_ = false;
+    shutdown_ = false;
+}
+
+template < typename T >
+void ring< T >::notify_()
+{
+    boost::lock_guard< boost::mutex > lock( mutex_ );
+    condition_.notify_all();
+}
+
+template < typename T >
+bool ring< T >::push( const T& t )
+{
+    slot& s = slots_[ tail_ % slots_.size() ];
+    bool dropped = false;
+    while( !dropped && s.sequence != 2 * tail_ ) // slot still holds the oldest item or a consumer is taking it
+    {
+        const comma::uint64 oldest = tail_ - slots_.size();
+        if( policy_ == drop_oldest )
+        {
+            if( head_ != oldest ) { boost::this_thread::yield(); continue; } // consumer is about to free the slot
+            dropped = head_.compare_and_swap( oldest + 1, oldest ) == oldest; // claim oldest item as if popped
+            continue;
+        }
+        boost::unique_lock< boost::mutex > lock( mutex_ );
+        producer_waiting_.fetch_and_store( true ); // fence: consumers see the flag, or we see the freed slot
+        while( s.sequence != 2 * tail_ && !shutdown_ ) { condition_.wait( lock ); }
+        producer_waiting_ = false;
+        if( shutdown_ && s.sequence != 2 * tail_ ) { return false; }
+    }
+    s.value = t;
+    s.sequence = 2 * tail_ + 1;
+    ++tail_;
+    published_.fetch_and_store( tail_ ); // fence: waiting consumers see the item, or we see them waiting
+    if( waiting_ > 0 ) { notify_(); }
+    if( dropped ) { ++dropped_; }
+    return !dropped;
+}
+
+template < typename T >
+bool ring< T >::try_pop( T& t )
+{
+    comma::uint64 position = head_;
+    while( true )
+    {
+        slot& s = slots_[ position % slots_.size() ];
+        const comma::uint64 sequence = s.sequence;
+        if( sequence < 2 * position + 1 ) { return false; } // not pushed yet
+        if( sequence > 2 * position + 1 ) { position = head_; continue; } // already popped and reused, head has moved
+        const comma::uint64 head = head_.compare_and_swap( position + 1, position );
+        if( head != position ) { position = head; continue; } // another consumer got it first
+        t = s.value;
+        s.value = T(); // release resources held by item, e.g. image buffers
+        s.sequence.fetch_and_store( 2 * ( position + slots_.size() ) ); // fence: blocked producer sees the free slot, or we see it waiting
+        if( producer_waiting_ ) { notify_(); }
+        return true;
+    }
+}
+
+template < typename T >
+void ring< T >::wait()
+{
+    if( !empty() || shutdown_ ) { return; }
+    boost::unique_lock< boost::mutex > lock( mutex_ );
+    waiting_.fetch_and_increment();
+    while( empty() && !shutdown_ ) { condition_.wait( lock ); }
+    waiting_.fetch_and_decrement();
+}
+
+template < typename T >
+void ring< T >::shutdown()
+{
+    shutdown_ = true;
+    notify_();
+}
+
+template < typename T >
+std::size_t ring< T >::size() const
+{
+    const comma::uint64 head = head_;
+    const comma::uint64 tail = published_;
+    return tail > head ? tail - head : 0;
+}
+
+} } // namespace snark{ namespace tbb{
+
+#endif // SNARK_TBB_RING_H_
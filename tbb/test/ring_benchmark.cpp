@@ -0,0 +1,123 @@
+// This file is part of snark, a generic and flexible library for robotics research
+// Copyright (c) 2011 The University of Sydney
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. All advertising materials mentioning features or use of this software
+//    must display the following acknowledgement:
+//    This product includes software developed by the The University of Sydney.
+// 4. Neither the name of the The University of Sydney nor the
+//    names of its contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+//
+// NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+// GRANTED BY THIS LICENSE.  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+// HOLDERS AND CONTRIBUTORS \"AS IS\" AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+// BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+// OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+// IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+/// compare wake-up latency and throughput of ring and queue
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <boost/bind.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/thread/thread.hpp>
+#include <comma/base/types.h>
+#include <snark/tbb/queue.h>
+#include <snark/tbb/ring.h>
+
+static const boost::posix_time::ptime epoch( boost::gregorian::date( 1970, 1, 1 ) );
+
+static comma::int64 now() { return ( boost::posix_time::microsec_clock::universal_time() - epoch ).total_microseconds(); }
+
+typedef snark::tbb::ring< comma::int64 > ring_t;
+typedef snark::tbb::queue< comma::int64 > queue_t;
+
+// push current time every period, 0 at the end
+template < typename Q > static void produce( Q* q, std::size_t size, unsigned int period )
+{
+    for( std::size_t i = 0; i < size; ++i )
+    {
+        if( period > 0 ) { boost::this_thread::sleep( boost::posix_time::microseconds( period ) ); }
+        q->push( now() );
+    }
+    q->push( 0 );
+}
+
+static bool pop( ring_t& q, comma::int64& t ) { return q.try_pop( t ); }
+
+static bool pop( queue_t& q, comma::int64& t ) { if( q.empty() ) { return false; } q.pop( t ); return true; }
+
+// wait for items as bursty_reader does and collect latencies
+template < typename Q > static void consume( Q* q, std::vector< comma::int64 >* latencies )
+{
+    while( true )
+    {
+        q->wait();
+        comma::int64 t;
+        while( pop( *q, t ) )
+        {
+            if( t == 0 ) { return; }
+            latencies->push_back( now() - t );
+        }
+    }
+}
+
+template < typename Q > static void run( const std::string& what, Q& q, std::size_t size, unsigned int period )
+{
+    std::vector< comma::int64 > latencies;
+    latencies.reserve( size );
+    comma::int64 start = now();
+    boost::thread consumer( boost::bind( &consume< Q >, &q, &latencies ) );
+    produce( &q, size, period );
+    consumer.join();
+    comma::int64 elapsed = now() - start;
+    std::sort( latencies.begin(), latencies.end() );
+    if( latencies.empty() ) { return; }
+    std::cout << what << ": " << latencies.size() << " items in " << elapsed << " us"
+              << "; latency, us: median " << latencies[ latencies.size() / 2 ]
+              << ", 99% " << latencies[ latencies.size() * 99 / 100 ]
+              << ", max " << latencies.back() << std::endl;
+}
+
+int main( int ac, char** av )
+{
+    std::size_t size = ac > 1 ? boost::lexical_cast< std::size_t >( av[1] ) : 2000;
+    unsigned int period = ac > 2 ? boost::lexical_cast< unsigned int >( av[2] ) : 1000;
+    {
+        queue_t q( 1024 );
+        run( "queue, sparse", q, size, period );
+    }
+    {
+        ring_t r( 1024, ring_t::block );
+        run( "ring, sparse", r, size, period );
+    }
+    {
+        queue_t q( 1024 );
+        run( "queue, burst", q, size * 500, 0 );
+    }
+    {
+        ring_t r( 1024, ring_t::block );
+        run( "ring, burst", r, size * 500, 0 );
+    }
+    return 0;
+}
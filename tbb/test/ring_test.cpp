@@ -0,0 +1,201 @@
+// This file is part of snark, a generic and flexible library for robotics research
+// Copyright (c) 2011 The University of Sydney
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. All advertising materials mentioning features or use of this software
+//    must display the following acknowledgement:
+//    This product includes software developed by the The University of Sydney.
+// 4. Neither the name of the The University of Sydney nor the
+//    names of its contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+//
+// NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+// GRANTED BY THIS LICENSE.  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+// HOLDERS AND CONTRIBUTORS \"AS IS\" AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+// BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+// OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+// IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+#include <gtest/gtest.h>
+#include <snark/tbb/ring.h>
+
+namespace snark { namespace test {
+
+TEST( ring, push_pop )
+{
+    snark::tbb::ring< int > ring( 3 );
+    int i;
+    EXPECT_TRUE( ring.empty() );
+    EXPECT_FALSE( ring.try_pop( i ) );
+    for( int k = 0; k < 10; ++k ) // several laps around the ring
+    {
+        EXPECT_TRUE( ring.push( k ) );
+        EXPECT_TRUE( ring.push( k + 100 ) );
+        EXPECT_EQ( 2u, ring.size() );
+        EXPECT_TRUE( ring.try_pop( i ) );
+        EXPECT_EQ( k, i );
+        EXPECT_TRUE( ring.try_pop( i ) );
+        EXPECT_EQ( k + 100, i );
+        EXPECT_FALSE( ring.try_pop( i ) );
+    }
+    EXPECT_EQ( 0u, ring.dropped() );
+}
+
+TEST( ring, drop_oldest )
+{
+    snark::tbb::ring< int > ring( 3 );
+    for( int k = 0; k < 3; ++k ) { EXPECT_TRUE( ring.push( k ) ); }
+    EXPECT_FALSE( ring.push( 3 ) );
+    EXPECT_FALSE( ring.push( 4 ) );
+    EXPECT_EQ( 3u, ring.size() );
+    EXPECT_EQ( 2u, ring.dropped() );
+    int i;
+    for( int k = 2; k < 5; ++k ) { EXPECT_TRUE( ring.try_pop( i ) ); EXPECT_EQ( k, i ); }
+    EXPECT_FALSE( ring.try_pop( i ) );
+}
+
+static void push_( snark::tbb::ring< int >* ring, int count )
+{
+    for( int i = 1; i <= count; ++i ) { ring->push( i ); }
+    ring->shutdown();
+}
+
+static void pop_( snark::tbb::ring< int >* ring, std::vector< int >* popped )
+{
+    while( true )
+    {
+        ring->wait();
+        int i;
+        bool empty = true;
+        while( ring->try_pop( i ) ) { popped->push_back( i ); empty = false; }
+        if( empty && ring->empty() ) { return; } // woken up by shutdown
+    }
+}
+
+static void run_( snark::tbb::ring< int >& ring, int count, std::vector< std::vector< int > >& popped )
+{
+    boost::thread_group consumers;
+    for( std::size_t i = 0; i < popped.size(); ++i ) { consumers.create_thread( boost::bind( &pop_, &ring, &popped[i] ) ); }
+    boost::thread producer( boost::bind( &push_, &ring, count ) );
+    producer.join();
+    consumers.join_all();
+}
+
+static bool ascending_( const std::vector< int >& v ) { return std::adjacent_find( v.begin(), v.end(), std::greater_equal< int >() ) == v.end(); }
+
+TEST( ring, block_multiple_consumers )
+{
+    const int count = 200000;
+    snark::tbb::ring< int > ring( 16, snark::tbb::ring< int >::block );
+    std::vector< std::vector< int > > popped( 4 );
+    run_( ring, count, popped );
+    std::vector< int > all;
+    for( std::size_t i = 0; i < popped.size(); ++i )
+    {
+        EXPECT_TRUE( ascending_( popped[i] ) ); // each consumer sees items in order
+        all.insert( all.end(), popped[i].begin(), popped[i].end() );
+    }
+    std::sort( all.begin(), all.end() );
+    ASSERT_EQ( std::size_t( count ), all.size() ); // nothing lost, nothing duplicated
+    for( int i = 0; i < count; ++i ) { ASSERT_EQ( i + 1, all[i] ); }
+    EXPECT_EQ( 0u, ring.dropped() );
+}
+
+TEST( ring, drop_oldest_multiple_consumers )
+{
+    const int count = 200000;
+    snark::tbb::ring< int > ring( 4 );
+    std::vector< std::vector< int > > popped( 3 );
+    run_( ring, count, popped );
+    std::vector< int > all;
+    for( std::size_t i = 0; i < popped.size(); ++i )
+    {
+        EXPECT_TRUE( ascending_( popped[i] ) );
+        all.insert( all.end(), popped[i].begin(), popped[i].end() );
+    }
+    std::sort( all.begin(), all.end() );
+    EXPECT_TRUE( ascending_( all ) ); // no duplicates
+    EXPECT_EQ( std::size_t( count ), all.size() + ring.dropped() );
+    EXPECT_EQ( count, all.back() ); // newest item is never dropped
+}
+
+static void wait_( snark::tbb::ring< int >* ring, bool* woken )
+{
+    ring->wait();
+    *woken = true;
+}
+
+TEST( ring, wait )
+{
+    snark::tbb::ring< int > ring( 4 );
+    bool woken = false;
+    boost::thread waiting( boost::bind( &wait_, &ring, &woken ) );
+    boost::this_thread::sleep( boost::posix_time::milliseconds( 20 ) );
+    EXPECT_FALSE( woken );
+    ring.push( 1 );
+    EXPECT_TRUE( waiting.timed_join( boost::posix_time::seconds( 1 ) ) );
+    EXPECT_TRUE( woken );
+    int i;
+    ring.try_pop( i );
+    woken = false;
+    boost::thread shutdown( boost::bind( &wait_, &ring, &woken ) );
+    boost::this_thread::sleep( boost::posix_time::milliseconds( 20 ) );
+    EXPECT_FALSE( woken );
+    ring.shutdown();
+    EXPECT_TRUE( shutdown.timed_join( boost::posix_time::seconds( 1 ) ) );
+    EXPECT_TRUE( woken );
+}
+
+static void push_two_( snark::tbb::ring< int >* ring, bool* pushed )
+{
+    *pushed = ring->push( 1 ) && ring->push( 2 );
+}
+
+TEST( ring, block )
+{
+    snark::tbb::ring< int > ring( 1, snark::tbb::ring< int >::block );
+    bool pushed = false;
+    boost::thread producer( boost::bind( &push_two_, &ring, &pushed ) );
+    boost::this_thread::sleep( boost::posix_time::milliseconds( 20 ) );
+    EXPECT_FALSE( pushed ); // blocked on full ring
+    int i;
+    EXPECT_TRUE( ring.try_pop( i ) );
+    EXPECT_EQ( 1, i );
+    EXPECT_TRUE( producer.timed_join( boost::posix_time::seconds( 1 ) ) );
+    EXPECT_TRUE( pushed );
+    EXPECT_TRUE( ring.try_pop( i ) );
+    EXPECT_EQ( 2, i );
+    ring.push( 3 );
+    boost::thread blocked( boost::bind( &push_two_, &ring, &pushed ) );
+    ring.shutdown();
+    EXPECT_TRUE( blocked.timed_join( boost::posix_time::seconds( 1 ) ) );
+    EXPECT_FALSE( pushed );
+}
+
+} } // namespace snark { namespace test {
+
+int main( int argc, char* argv[] )
+{
+    ::testing::InitGoogleTest( &argc, argv );
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,136 @@
+// This file is part of snark, a generic and flexible library for robotics research
+// Copyright (c) 2011 The University of Sydney
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. All advertising materials mentioning features or use of this software
+//    must display the following acknowledgement:
+//    This product includes software developed by the The University of Sydney.
+// 4. Neither the name of the The University of Sydney nor the
+//    names of its contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+//
+// NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+// GRANTED BY THIS LICENSE.  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+// HOLDERS AND CONTRIBUTORS \"AS IS\" AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+// BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+// OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+// IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <cmath>
+#include <comma/base/exception.h>
+#include <snark/timing/clock_alignment.h>
+
+namespace snark{ namespace timing {
+
+static const std::size_t warmup = 10; // events accepted unconditionally to get the first estimate of deviation
+
+clock_alignment::clock_alignment( std::size_t window, double threshold, const boost::posix_time::time_duration& tolerance, std::size_t max_outliers, double max_drift )
+    : m_lambda( 1.0 - 1.0 / window )
+    , m_threshold( threshold )
+    , m_tolerance( double( tolerance.total_microseconds() ) / 1e6 )
+    , m_max_outliers( max_outliers )
+    , m_max_drift( max_drift )
+    , m_outliers( 0 )
+    , m_restarts( 0 )
+{
+    if( window == 0 ) { COMMA_THROW( comma::exception, "expected positive window, got 0" ); }
+    if( max_drift <= 0 ) { COMMA_THROW( comma::exception, "expected positive max drift, got " << max_drift ); }
+    reset();
+}
+
+void clock_alignment::reset()
+{
+    m_weight = 0;
+    m_mean_x = 0;
+    m_mean_y = 0;
+    m_cxx = 0;
+    m_cxy = 0;
+    m_deviation = 0;
+    m_last_x = 0;
+    m_count = 0;
+    m_consecutive_outliers = 0;
+}
+
+double clock_alignment::drift() const
+{
+    if( m_count < 2 ) { return 0; }
+    // ridge regression: drift of the order of max_drift costs as much as the deviation of a single event
+    double noise = m_deviation + m_tolerance;
+    return m_cxy / ( m_cxx + noise * noise / ( m_max_drift * m_max_drift * m_weight ) );
+}
+
+double clock_alignment::fitted_( double x ) const { return m_mean_y + drift() * ( x - m_mean_x ); }
+
+bool clock_alignment::update( const timestamp& sensor, const timestamp& host )
+{
+    if( m_count == 0 )
+    {
+        m_origin = sensor.microseconds();
+        m_origin_offset = host - sensor;
+    }
+    double x = double( sensor.microseconds() - m_origin ) / 1e6;
+    double y = double( host - sensor - m_origin_offset ) / 1e6;
+    double residual = m_count == 0 ? 0 : std::fabs( y - fitted_( x ) );
+    if( m_count >= warmup && residual > m_threshold * m_deviation + m_tolerance )
+    {
+        ++m_outliers;
+        if( ++m_consecutive_outliers <= m_max_outliers ) { return false; }
+        ++m_restarts; // sensor clock stepped: start over from this event
+        reset();
+        return update( sensor, host );
+    }
+    m_consecutive_outliers = 0;
+    m_weight = m_lambda * m_weight + 1;
+    double alpha = 1.0 / m_weight;
+    double dx = x - m_mean_x;
+    double dy = y - m_mean_y;
+    m_mean_x += alpha * dx;
+    m_mean_y += alpha * dy;
+    m_cxx = ( 1 - alpha ) * ( m_cxx + alpha * dx * dx );
+    m_cxy = ( 1 - alpha ) * ( m_cxy + alpha * dx * dy );
+    if( m_count > 0 ) { m_deviation += ( residual - m_deviation ) * ( m_count < warmup ? 1.0 / m_count : alpha ); }
+    m_last_x = x;
+    ++m_count;
+    return true;
+}
+
+timestamp clock_alignment::to_host( const timestamp& sensor ) const
+{
+    if( m_count == 0 ) { return sensor; }
+    double x = double( sensor.microseconds() - m_origin ) / 1e6;
+    return sensor + m_origin_offset + static_cast< comma::int64 >( std::floor( fitted_( x ) * 1e6 + 0.5 ) );
+}
+
+timestamp clock_alignment::adjusted( const timestamp& sensor, const timestamp& host )
+{
+    update( sensor, host );
+    return to_host( sensor );
+}
+
+boost::posix_time::ptime clock_alignment::adjusted( const boost::posix_time::ptime& sensor, const boost::posix_time::ptime& host )
+{
+    return adjusted( timestamp( sensor ), timestamp( host ) ).to_ptime();
+}
+
+boost::posix_time::time_duration clock_alignment::offset() const
+{
+    if( m_count == 0 ) { return boost::posix_time::time_duration(); }
+    return boost::posix_time::microseconds( m_origin_offset + static_cast< comma::int64 >( std::floor( fitted_( m_last_x ) * 1e6 + 0.5 ) ) );
+}
+
+} } // namespace snark{ namespace timing
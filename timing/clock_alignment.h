@@ -0,0 +1,124 @@
+// This file is part of snark, a generic and flexible library for robotics research
+// Copyright (c) 2011 The University of Sydney
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. All advertising materials mentioning features or use of this software
+//    must display the following acknowledgement:
+//    This product includes software developed by the The University of Sydney.
+// 4. Neither the name of the The University of Sydney nor the
+//    names of its contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+//
+// NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+// GRANTED BY THIS LICENSE.  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+// HOLDERS AND CONTRIBUTORS \"AS IS\" AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+// BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+// OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+// IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef SNARK_TIMING_CLOCK_ALIGNMENT_H_
+#define SNARK_TIMING_CLOCK_ALIGNMENT_H_
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <comma/base/types.h>
+#include <snark/timing/timestamp.h>
+
+namespace snark{ namespace timing {
+
+/// fits sensor clock to host clock incrementally as host = sensor + offset + drift * elapsed sensor time
+///
+/// each event carries a sensor timestamp (e.g. camera ticks, laser ntp time) and the host
+/// reception time; host times jitter with system load, sensor times do not, thus
+/// mapping sensor times through the fit gives host-aligned timestamps free of jitter
+///
+/// the fit is an exponentially weighted least squares line over the last few events,
+/// updated in O(1); events whose host time deviates from the fit by much more than
+/// the typical deviation (e.g. scheduling delays) are rejected as outliers; if too many
+/// consecutive events are rejected, the sensor clock is assumed to have stepped and the fit restarts
+///
+/// the mean transport latency remains in the offset, as it is indistinguishable from clock offset
+class clock_alignment
+{
+    public:
+        /// constructor
+        /// @param window number of events, over which the fit is effectively averaged
+        /// @param threshold events deviating from the fit by more than threshold * mean deviation + tolerance are outliers
+        /// @param tolerance deviation always accepted, roughly host timestamping jitter
+        /// @param max_outliers number of consecutive outliers after which the fit restarts
+        /// @param max_drift expected magnitude of drift, e.g. 1e-4 for 100 ppm; stabilises the drift over the first events
+        clock_alignment( std::size_t window = 1000
+                       , double threshold = 4
+                       , const boost::posix_time::time_duration& tolerance = boost::posix_time::microseconds( 100 )
+                       , std::size_t max_outliers = 50
+                       , double max_drift = 1e-4 );
+
+        /// update fit with event timestamps
+        /// @return false, if event was rejected as outlier
+        bool update( const timestamp& sensor, const timestamp& host );
+
+        /// update fit and return host-aligned time of event
+        timestamp adjusted( const timestamp& sensor, const timestamp& host );
+        boost::posix_time::ptime adjusted( const boost::posix_time::ptime& sensor, const boost::posix_time::ptime& host );
+
+        /// map sensor time to host time; sensor time as is, if no events yet
+        timestamp to_host( const timestamp& sensor ) const;
+
+        /// return current host minus sensor time at the last accepted event
+        boost::posix_time::time_duration offset() const;
+
+        /// return current drift of host clock relative to sensor clock, e.g. 1e-5 for 10 ppm
+        double drift() const;
+
+        /// return number of accepted events since start or last restart
+        std::size_t count() const { return m_count; }
+
+        /// return total number of rejected events
+        std::size_t outliers() const { return m_outliers; }
+
+        /// return number of restarts due to sensor clock steps
+        std::size_t restarts() const { return m_restarts; }
+
+        /// restart the fit
+        void reset();
+
+    private:
+        double m_lambda;
+        double m_threshold;
+        double m_tolerance;
+        std::size_t m_max_outliers;
+        double m_max_drift;
+        comma::int64 m_origin; // sensor time of first event
+        comma::int64 m_origin_offset; // host minus sensor time of first event
+        double m_weight;
+        double m_mean_x; // seconds of sensor time since first event
+        double m_mean_y; // seconds of offset change since first event
+        double m_cxx;
+        double m_cxy;
+        double m_deviation;
+        double m_last_x;
+        std::size_t m_count;
+        std::size_t m_outliers;
+        std::size_t m_consecutive_outliers;
+        std::size_t m_restarts;
+
+        double fitted_( double x ) const;
+};
+
+} } // namespace snark{ namespace timing
+
+#endif /*SNARK_TIMING_CLOCK_ALIGNMENT_H_*/
@@ -31,7 +31,9 @@
 // IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 
+#include <limits>
 #include <snark/timing/play.h>
+#include <snark/timing/time.h>
 
 #include <boost/thread/thread.hpp>
 #include <boost/thread/thread_time.hpp>
@@ -41,11 +43,29 @@ namespace snark
 {
 namespace timing
 {
-    
-/// constructor    
+
+static const boost::posix_time::ptime epoch_time( epoch );
+
+static comma::int64 to_microseconds( const boost::posix_time::ptime& t ) { return ( t - epoch_time ).total_microseconds(); }
+
+static comma::int64 now() { return to_microseconds( boost::get_system_time() ); }
+
+/// constructor
+/// @param first first timestamp, played now
+/// @param speed slow-down factor
+play::clock::clock( const boost::posix_time::ptime& first, double speed ) :
+    m_reference( std::make_pair( now(), to_microseconds( first ) ) ),
+    m_speed( speed )
+{
+}
+
+/// constructor
 play::play( double speed, bool quiet, const boost::posix_time::time_duration& precision ):
+    m_last( std::numeric_limits< comma::int64 >::min() ),
+    m_released( std::numeric_limits< comma::int64 >::min() ),
     m_speed( speed ),
-    m_precision( precision ),
+    m_precision( precision.total_microseconds() ),
+    m_spin( 100 ),
     m_lag( false ),
     m_lagCounter( 0U ),
     m_quiet( quiet )
@@ -56,72 +76,86 @@ play::play( double speed, bool quiet, const boost::posix_time::time_duration& pr
 /// @param first first timestamp
 /// @param speed slow-down factor: 1.0 = real time, 2.0 = twice as slow etc...
 /// @param quiet if true, do not output warnings if we can not keep up with the desired playback speed
-/// @param precision expected precision from the sleep function
+/// @param precision expected precision from the sleep function; records due within precision are played together
 play::play( const boost::posix_time::ptime& first, double speed, bool quiet, const boost::posix_time::time_duration& precision ):
-
-    m_systemFirst( boost::get_system_time() ),
-    m_offset( m_systemFirst - first ),
-    m_first( first ),
-    m_last( first ),
+    m_clock( new clock( first, speed ) ),
+    m_last( std::numeric_limits< comma::int64 >::min() ),
+    m_released( std::numeric_limits< comma::int64 >::min() ),
     m_speed( speed ),
-    m_precision( precision ),
+    m_precision( precision.total_microseconds() ),
+    m_spin( 100 ),
     m_lag( false ),
     m_lagCounter( 0U ),
     m_quiet( quiet )
 {
-    
 }
 
+/// constructor
+/// @param c clock shared with other streams played in sync
+play::play( const boost::shared_ptr< clock >& c, bool quiet, const boost::posix_time::time_duration& precision ):
+    m_clock( c ),
+    m_last( std::numeric_limits< comma::int64 >::min() ),
+    m_released( std::numeric_limits< comma::int64 >::min() ),
+    m_speed( c->speed() ),
+    m_precision( precision.total_microseconds() ),
+    m_spin( 100 ),
+    m_lag( false ),
+    m_lagCounter( 0U ),
+    m_quiet( quiet )
+{
+}
+
+void play::spin( const boost::posix_time::time_duration& d ) { m_spin = d.total_microseconds(); }
 
 /// wait until a timestamp
 /// @param time timestamp as ptime
-void play::wait( const boost::posix_time::ptime& time )
-{
+void play::wait( const boost::posix_time::ptime& time ) { wait( timestamp( time ) ); }
 
-    if ( !m_offset )
+/// wait until a timestamp
+/// @param time timestamp
+void play::wait( const timestamp& time )
+{
+    const comma::int64 t = time.microseconds();
+    if( !m_reference ) { m_reference = m_clock ? m_clock->reference() : std::make_pair( now(), t ); }
+    if( t <= m_last ) { return; } // timestamp same or earlier than last time, nothing to do
+    m_last = t;
+    ++m_statistics.count;
+    const comma::int64 deadline = m_reference->first + static_cast< comma::int64 >( ( t - m_reference->second ) * m_speed );
+    if( deadline <= m_released ) { return; } // due within precision of last release: play without reading the clock
+    comma::int64 system_time = now();
+    const comma::int64 lag = system_time - deadline;
+    if( lag > m_precision ) // no need to be alarmed for a lag less than the expected accuracy
     {
-        boost::posix_time::ptime systemTime = boost::get_system_time();
-        m_offset = systemTime - time;
-        m_systemFirst = systemTime;
-        m_first = time;
-        m_last = time;
-    }
-    else
-    {        
-        if ( time > m_last )
+        const boost::posix_time::time_duration d = boost::posix_time::microseconds( lag );
+        ++m_statistics.lagging;
+        m_statistics.total_lag += d;
+        if( d > m_statistics.max_lag ) { m_statistics.max_lag = d; }
+        if( !m_quiet )
         {
-            boost::posix_time::ptime systemTime = boost::get_system_time();
-            const boost::posix_time::ptime target = m_systemFirst + boost::posix_time::milliseconds( static_cast<long>(( time - m_first ).total_milliseconds() * m_speed ) );
-            const boost::posix_time::time_duration lag = systemTime - target;
-            if ( !m_quiet && ( lag > m_precision ) ) // no need to be alarmed for a lag less than the expected accuracy
-            {
-                if( !m_lag )
-                {
-                    m_lag = true;
-                    std::cerr << "csv-play: warning, lagging behind " << lag << std::endl;
-                }
-                m_lagCounter++;
-            }
-            else
+            if( !m_lag )
             {
-                if( !m_quiet && m_lag )
-                {
-                    m_lag = false;
-                    std::cerr << "csv-play: recovered after " << m_lagCounter << " packets " << std::endl;
-                    m_lagCounter = 0U;
-                }
-                if ( lag < -m_precision ) // no need to sleep less than the expected accuracy
-                {
-                    boost::this_thread::sleep( target );
-                }
+                m_lag = true;
+                std::cerr << "csv-play: warning, lagging behind " << d << std::endl;
             }
-            m_last = time;
-        }
-        else
-        {
-            // timestamp same or earlier than last time, nothing to do
+            m_lagCounter++;
         }
+        m_released = system_time;
+        return;
+    }
+    if( m_lag )
+    {
+        m_lag = false;
+        std::cerr << "csv-play: recovered after " << m_lagCounter << " packets " << std::endl;
+        m_lagCounter = 0U;
+    }
+    if( deadline - system_time > m_spin ) // absolute deadline, thus no drift accumulates from sleep overshoot
+    {
+        ++m_statistics.sleeps;
+        boost::this_thread::sleep( epoch_time + boost::posix_time::microseconds( deadline - m_spin ) );
+        system_time = now();
     }
+    while( system_time < deadline ) { system_time = now(); } // spin for the last microseconds
+    m_released = system_time + m_precision;
 }
 
 
@@ -129,7 +163,7 @@ void play::wait( const boost::posix_time::ptime& time )
 /// @param isoTime timestamp in iso format
 void play::wait( const std::string& iso_time )
 {
-    wait( boost::posix_time::from_iso_string( iso_time ) );
+    wait( timestamp::from_iso_string( iso_time ) );
 }
 
 
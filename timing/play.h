@@ -35,7 +35,10 @@
 #define SNARK_TIMING_PLAY_H
 
 #include <boost/optional.hpp>
+#include <boost/shared_ptr.hpp>
 #include <boost/date_time/posix_time/posix_time.hpp>
+#include <comma/base/types.h>
+#include <snark/timing/timestamp.h>
 
 namespace snark
 {
@@ -43,26 +46,72 @@ namespace timing
 {
 
 /// play back timestamped data in a real time manner
+///
+/// sleeps until an absolute deadline and spins for the last few microseconds,
+/// records due within precision of the last release are let through without
+/// reading the clock, thus fast streams are released in small batches
 class play
 {
 public:
+    /// time reference shared by several streams to replay them in sync, e.g. from different threads
+    ///
+    /// the start is explicit: taking it from whichever stream plays first would depend on thread scheduling
+    class clock
+    {
+    public:
+        /// reference is set now: first timestamp maps to current system time
+        clock( const boost::posix_time::ptime& first, double speed = 1.0 );
+
+        /// @return system time and timestamp of the reference in microseconds since epoch
+        const std::pair< comma::int64, comma::int64 >& reference() const { return m_reference; }
+
+        double speed() const { return m_speed; }
+
+    private:
+        const std::pair< comma::int64, comma::int64 > m_reference;
+        const double m_speed;
+    };
+
+    /// lag statistics
+    struct statistics
+    {
+        comma::uint64 count; /// number of records played
+        comma::uint64 lagging; /// number of records played later than precision
+        comma::uint64 sleeps; /// number of times the thread slept
+        boost::posix_time::time_duration max_lag;
+        boost::posix_time::time_duration total_lag; /// of lagging records
+
+        statistics() : count( 0 ), lagging( 0 ), sleeps( 0 ) {}
+        boost::posix_time::time_duration mean_lag() const { return lagging == 0 ? boost::posix_time::time_duration() : total_lag / static_cast< int >( lagging ); }
+    };
+
     play( double speed = 1.0, bool quiet = false, const boost::posix_time::time_duration& precision = boost::posix_time::milliseconds(1) );
     play( const boost::posix_time::ptime& first, double speed = 1.0, bool quiet = false, const boost::posix_time::time_duration& precision = boost::posix_time::milliseconds(1) );
+    play( const boost::shared_ptr< clock >& c, bool quiet = false, const boost::posix_time::time_duration& precision = boost::posix_time::milliseconds(1) );
 
     void wait( const boost::posix_time::ptime& time );
 
     void wait( const std::string& iso_time );
 
+    void wait( const timestamp& time );
+
+    /// how long to busy-wait before a deadline instead of sleeping; default: 100 microseconds
+    void spin( const boost::posix_time::time_duration& d );
+
+    const statistics& stats() const { return m_statistics; }
+
 private:
-    boost::posix_time::ptime m_systemFirst; /// system time at first timestamp
-    boost::optional< boost::posix_time::time_duration > m_offset; /// offset between timestamps and system time
-    boost::posix_time::ptime m_first; /// first timestamp
-    boost::posix_time::ptime m_last; /// last timestamp received
+    boost::shared_ptr< clock > m_clock;
+    boost::optional< std::pair< comma::int64, comma::int64 > > m_reference; /// copy of clock reference or, without clock, set on first timestamp
+    comma::int64 m_last; /// last timestamp received
+    comma::int64 m_released; /// system time up to which records are released without reading the clock
     const double m_speed;
-    const boost::posix_time::time_duration m_precision;
+    const comma::int64 m_precision;
+    comma::int64 m_spin;
     bool m_lag;
     unsigned int m_lagCounter;
     bool m_quiet;
+    statistics m_statistics;
 };
 
 }
@@ -0,0 +1,78 @@
+// This file is part of snark, a generic and flexible library for robotics research
+// Copyright (c) 2011 The University of Sydney
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. All advertising materials mentioning features or use of this software
+//    must display the following acknowledgement:
+//    This product includes software developed by the The University of Sydney.
+// 4. Neither the name of the The University of Sydney nor the
+//    names of its contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+//
+// NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+// GRANTED BY THIS LICENSE.  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+// HOLDERS AND CONTRIBUTORS \"AS IS\" AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+// BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+// OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+// IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+/// compare timestamp parsing and formatting against boost::posix_time
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/lexical_cast.hpp>
+#include <snark/timing/time.h>
+#include <snark/timing/timestamp.h>
+
+static boost::posix_time::ptime now() { return boost::posix_time::microsec_clock::universal_time(); }
+
+static void report( const std::string& what, const boost::posix_time::ptime& start, std::size_t size )
+{
+    std::cout << what << ": " << double( ( now() - start ).total_microseconds() ) * 1000 / size << " ns per timestamp" << std::endl;
+}
+
+int main( int ac, char** av )
+{
+    std::size_t size = ac > 1 ? boost::lexical_cast< std::size_t >( av[1] ) : 1000000;
+    boost::posix_time::ptime first( snark::timing::epoch, boost::posix_time::hours( 24 * 365 * 40 ) );
+    std::vector< boost::posix_time::ptime > times( size );
+    for( std::size_t i = 0; i < size; ++i ) { times[i] = first + boost::posix_time::microseconds( i * 1237 ); }
+    std::vector< std::string > strings( size );
+    for( std::size_t i = 0; i < size; ++i ) { strings[i] = boost::posix_time::to_iso_string( times[i] ); }
+    comma::int64 sum = 0; // use results, not to have the loops optimised away
+    boost::posix_time::ptime start = now();
+    for( std::size_t i = 0; i < size; ++i ) { sum += ( boost::posix_time::from_iso_string( strings[i] ) - first ).total_microseconds(); }
+    report( "parse iso, boost", start, size );
+    start = now();
+    for( std::size_t i = 0; i < size; ++i ) { sum -= snark::timing::timestamp::from_iso_string( strings[i] ).microseconds(); }
+    report( "parse iso, timestamp", start, size );
+    start = now();
+    for( std::size_t i = 0; i < size; ++i ) { sum += boost::posix_time::to_iso_string( times[i] ).size(); }
+    report( "format iso, boost", start, size );
+    char buf[ snark::timing::timestamp::iso_size ];
+    start = now();
+    for( std::size_t i = 0; i < size; ++i ) { sum -= snark::timing::timestamp( times[i] ).to_iso_string( buf ); }
+    report( "format iso, timestamp, to buffer", start, size );
+    start = now();
+    for( std::size_t i = 0; i < size; ++i ) { sum += snark::timing::timestamp( times[i] ).to_iso_string().size(); }
+    report( "format iso, timestamp, to string", start, size );
+    std::cerr << "checksum: " << sum << std::endl;
+    return 0;
+}
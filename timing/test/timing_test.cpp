@@ -31,12 +31,18 @@
 // IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 
+#include <vector>
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
 #include <gtest/gtest.h>
+#include <comma/base/exception.h>
 #include <comma/math/compare.h>
+#include <snark/timing/clock_alignment.h>
 #include <snark/timing/clocked_time_stamp.h>
 #include <snark/timing/play.h>
 #include <snark/timing/ntp.h>
 #include <snark/timing/time.h>
+#include <snark/timing/timestamp.h>
 
 namespace snark { namespace test {
 
@@ -182,6 +188,201 @@ TEST(time, NTP)
     testTime( "20100101T000000.999999" );
 }
 
+static void play_( timing::play* p, const std::vector< boost::posix_time::ptime >* timestamps )
+{
+    for( std::size_t i = 0; i < timestamps->size(); ++i ) { p->wait( ( *timestamps )[i] ); }
+}
+
+TEST(time, play)
+{
+    boost::posix_time::ptime t = make_time( 1000 );
+    std::vector< boost::posix_time::ptime > timestamps;
+    for( unsigned int i = 0; i < 200; ++i ) { timestamps.push_back( t + boost::posix_time::microseconds( i * 250 ) ); } // 4 kHz for 50 ms
+    timing::play p( 1.0, true, boost::posix_time::microseconds( 500 ) );
+    boost::posix_time::ptime start = boost::get_system_time();
+    play_( &p, &timestamps );
+    boost::posix_time::time_duration elapsed = boost::get_system_time() - start;
+    EXPECT_LE( boost::posix_time::microseconds( 49750 - 500 ), elapsed );
+    EXPECT_GT( boost::posix_time::milliseconds( 500 ), elapsed );
+    EXPECT_EQ( 200u, p.stats().count );
+    EXPECT_GT( 200u, p.stats().sleeps ); // records due within precision played together
+    p.wait( t ); // earlier timestamp, nothing to do
+    EXPECT_EQ( 200u, p.stats().count );
+}
+
+TEST(time, play_speed)
+{
+    timing::play p( 0.5, true, boost::posix_time::microseconds( 100 ) );
+    boost::posix_time::ptime start = boost::get_system_time();
+    p.wait( make_time( 10 ) );
+    p.wait( make_time( 10 ) + boost::posix_time::milliseconds( 40 ) );
+    boost::posix_time::time_duration elapsed = boost::get_system_time() - start;
+    EXPECT_LE( boost::posix_time::milliseconds( 20 ), elapsed );
+    EXPECT_GT( boost::posix_time::milliseconds( 40 ), elapsed );
+}
+
+TEST(time, play_lag)
+{
+    timing::play p( 1.0, true, boost::posix_time::milliseconds( 1 ) );
+    p.wait( make_time( 10 ) );
+    boost::this_thread::sleep( boost::posix_time::milliseconds( 20 ) );
+    p.wait( make_time( 10 ) + boost::posix_time::milliseconds( 5 ) );
+    EXPECT_EQ( 1u, p.stats().lagging );
+    EXPECT_LE( boost::posix_time::milliseconds( 14 ), p.stats().max_lag );
+    EXPECT_EQ( p.stats().max_lag, p.stats().mean_lag() );
+}
+
+TEST(time, play_shared_clock)
+{
+    boost::shared_ptr< timing::play::clock > clock( new timing::play::clock( make_time( 10 ), 1.0 ) );
+    timing::play first( clock, true, boost::posix_time::microseconds( 200 ) );
+    timing::play second( clock, true, boost::posix_time::microseconds( 200 ) );
+    std::vector< boost::posix_time::ptime > first_timestamps;
+    std::vector< boost::posix_time::ptime > second_timestamps;
+    for( unsigned int i = 0; i < 30; ++i ) { first_timestamps.push_back( make_time( 10 ) + boost::posix_time::milliseconds( i ) ); }
+    for( unsigned int i = 0; i < 10; ++i ) { second_timestamps.push_back( make_time( 10 ) + boost::posix_time::milliseconds( 20 + i * 2 ) ); }
+    boost::posix_time::ptime start = boost::get_system_time();
+    boost::thread first_thread( boost::bind( &play_, &first, &first_timestamps ) );
+    boost::thread second_thread( boost::bind( &play_, &second, &second_timestamps ) );
+    first_thread.join();
+    boost::posix_time::time_duration first_elapsed = boost::get_system_time() - start;
+    second_thread.join();
+    boost::posix_time::time_duration second_elapsed = boost::get_system_time() - start;
+    EXPECT_LE( boost::posix_time::microseconds( 29000 - 200 ), first_elapsed );
+    EXPECT_LE( boost::posix_time::microseconds( 38000 - 200 ), second_elapsed ); // second stream starts 20 ms later on the same clock
+    EXPECT_GT( boost::posix_time::milliseconds( 500 ), second_elapsed );
+}
+
+static void test_timestamp( const boost::posix_time::ptime& t )
+{
+    timing::timestamp s( t );
+    EXPECT_EQ( t, s.to_ptime() );
+    EXPECT_EQ( boost::posix_time::to_iso_string( t ), s.to_iso_string() );
+    EXPECT_EQ( s, timing::timestamp::from_iso_string( boost::posix_time::to_iso_string( t ) ) );
+    EXPECT_EQ( s, timing::timestamp::from_epoch_string( s.to_epoch_string() ) );
+}
+
+TEST(time, timestamp)
+{
+    boost::posix_time::ptime epoch( timing::epoch );
+    test_timestamp( epoch );
+    test_timestamp( epoch - boost::posix_time::microseconds( 1 ) );
+    test_timestamp( epoch - boost::posix_time::seconds( 1 ) );
+    test_timestamp( boost::posix_time::ptime( boost::gregorian::date( 1900, 3, 1 ), boost::posix_time::microseconds( 123 ) ) );
+    test_timestamp( boost::posix_time::ptime( boost::gregorian::date( 2000, 2, 29 ), boost::posix_time::hours( 23 ) + boost::posix_time::minutes( 59 ) + boost::posix_time::seconds( 59 ) ) );
+    test_timestamp( boost::posix_time::ptime( boost::gregorian::date( 9999, 12, 31 ), boost::posix_time::microseconds( 999999 ) ) );
+    for( unsigned int i = 0; i < 10000; ++i ) // about 300 years either side of epoch
+    {
+        comma::int64 microseconds = ( static_cast< comma::int64 >( i ) - 5000 ) * 1999999999999LL + i * 7919;
+        test_timestamp( epoch + boost::posix_time::microseconds( microseconds ) );
+    }
+    EXPECT_TRUE( timing::timestamp().is_not_a_date_time() );
+    EXPECT_TRUE( timing::timestamp( boost::posix_time::ptime( boost::posix_time::not_a_date_time ) ).to_ptime().is_not_a_date_time() );
+    EXPECT_EQ( "not-a-date-time", timing::timestamp().to_iso_string() );
+    EXPECT_TRUE( timing::timestamp::from_iso_string( "not-a-date-time" ).is_not_a_date_time() );
+}
+
+TEST(time, timestamp_special)
+{
+    const boost::posix_time::ptime special[] = { boost::posix_time::ptime( boost::posix_time::not_a_date_time ), boost::posix_time::ptime( boost::posix_time::pos_infin ), boost::posix_time::ptime( boost::posix_time::neg_infin ) };
+    for( unsigned int i = 0; i < 3; ++i )
+    {
+        timing::timestamp s( special[i] );
+        EXPECT_TRUE( s.is_special() );
+        EXPECT_EQ( boost::posix_time::to_iso_string( special[i] ), boost::posix_time::to_iso_string( s.to_ptime() ) );
+        EXPECT_EQ( boost::posix_time::to_iso_string( special[i] ), s.to_iso_string() );
+        EXPECT_EQ( s, timing::timestamp::from_iso_string( s.to_iso_string() ) );
+        EXPECT_EQ( s, timing::timestamp::from_epoch_string( s.to_epoch_string() ) );
+        EXPECT_EQ( s, s + 1000 );
+        EXPECT_EQ( s, s - 1000 );
+    }
+    EXPECT_TRUE( timing::timestamp( boost::posix_time::ptime( boost::posix_time::pos_infin ) ).is_pos_infinity() );
+    EXPECT_TRUE( timing::timestamp( boost::posix_time::ptime( boost::posix_time::neg_infin ) ).is_neg_infinity() );
+    EXPECT_LT( timing::timestamp::neg_infin(), timing::timestamp( -1000000000000000000LL ) );
+    EXPECT_GT( timing::timestamp::pos_infin(), timing::timestamp( 1000000000000000000LL ) );
+    EXPECT_FALSE( timing::timestamp( 0 ).is_special() );
+}
+
+TEST(time, timestamp_parse)
+{
+    EXPECT_EQ( 1262304000123456LL, timing::timestamp::from_iso_string( "20100101T000000.123456" ).microseconds() );
+    EXPECT_EQ( 1262304000500000LL, timing::timestamp::from_iso_string( "20100101T000000.5" ).microseconds() );
+    EXPECT_EQ( 1262304000123456LL, timing::timestamp::from_iso_string( "20100101T000000.123456789" ).microseconds() );
+    EXPECT_EQ( 1262304000123456LL, timing::timestamp::from_epoch_string( "1262304000.123456" ).microseconds() );
+    EXPECT_EQ( 1262304000000000LL, timing::timestamp::from_epoch_string( "1262304000" ).microseconds() );
+    EXPECT_EQ( -1500000LL, timing::timestamp::from_epoch_string( "-1.5" ).microseconds() );
+    EXPECT_EQ( "-1.500000", timing::timestamp( -1500000 ).to_epoch_string() );
+    EXPECT_EQ( "1262304000.000001", timing::timestamp( 1262304000000001LL ).to_epoch_string() );
+    EXPECT_EQ( boost::posix_time::ptime( boost::gregorian::date( 2000, 2, 29 ) ), timing::timestamp::from_iso_string( "20000229T000000" ).to_ptime() );
+    EXPECT_EQ( boost::posix_time::ptime( boost::gregorian::date( 2012, 2, 29 ) ), timing::timestamp::from_iso_string( "20120229T000000" ).to_ptime() );
+    const char* invalid[] = { "", "20100101", "20100101 000000", "20101301T000000", "20100101T240000", "20100101T000000.", "20100101T000000x", "2010010aT000000", "not-a-date"
+                            , "20100231T000000", "20100431T000000", "20100229T000000", "19000229T000000", "20100132T000000", "20100100T000000", "infinity" };
+    for( unsigned int i = 0; i < sizeof( invalid ) / sizeof( invalid[0] ); ++i ) { EXPECT_THROW( timing::timestamp::from_iso_string( invalid[i] ), comma::exception ); }
+    EXPECT_THROW( timing::timestamp::from_epoch_string( "" ), comma::exception );
+    EXPECT_THROW( timing::timestamp::from_epoch_string( "12a" ), comma::exception );
+    EXPECT_THROW( timing::timestamp::from_epoch_string( "1." ), comma::exception );
+    EXPECT_TRUE( timing::timestamp::from_iso_string( "+infinity" ).is_pos_infinity() );
+    EXPECT_TRUE( timing::timestamp::from_epoch_string( "-infinity" ).is_neg_infinity() );
+    timing::timestamp t( 1000 );
+    EXPECT_EQ( 500, t - timing::timestamp( 500 ) );
+    EXPECT_EQ( timing::timestamp( 1500 ), t + 500 );
+    EXPECT_LT( timing::timestamp( 500 ), t );
+}
+
+static comma::int64 jitter( unsigned int& seed, comma::int64 max ) // deterministic, not to depend on platform random generators
+{
+    seed = seed * 1103515245 + 12345;
+    return ( seed >> 8 ) % max;
+}
+
+TEST(time, clock_alignment)
+{
+    timing::clock_alignment alignment;
+    unsigned int seed = 1;
+    const comma::int64 offset = 3000000; // sensor clock 3 seconds behind
+    const double drift = 5e-5; // and 50 ppm slow
+    const comma::int64 latency = 500;
+    comma::int64 max_error = 0;
+    for( comma::int64 i = 0; i < 5000; ++i )
+    {
+        comma::int64 t = 1262304000000000LL + i * 10000; // 100 Hz for 50 seconds
+        timing::timestamp sensor( t - offset - static_cast< comma::int64 >( ( t - 1262304000000000LL ) * drift ) );
+        comma::int64 delay = latency + jitter( seed, 200 ) + ( i % 97 == 50 ? 20000 : 0 ); // jitter and occasional scheduling delay
+        timing::timestamp adjusted = alignment.adjusted( sensor, timing::timestamp( t + delay ) );
+        if( i > 1000 ) { max_error = std::max( max_error, std::abs( adjusted.microseconds() - t - latency - 100 ) ); }
+    }
+    EXPECT_GT( 10, max_error ); // within 10 microseconds after warming up
+    EXPECT_NEAR( drift, alignment.drift(), 1e-6 );
+    EXPECT_EQ( 5000u - alignment.outliers(), alignment.count() );
+    EXPECT_LE( 50u, alignment.outliers() );
+    EXPECT_EQ( 0u, alignment.restarts() );
+}
+
+TEST(time, clock_alignment_step)
+{
+    timing::clock_alignment alignment( 100, 4, boost::posix_time::microseconds( 100 ), 10 );
+    unsigned int seed = 1;
+    comma::int64 step = 0;
+    for( comma::int64 i = 0; i < 1000; ++i )
+    {
+        if( i == 500 ) { step = 1000000; } // sensor clock reset by a second
+        comma::int64 t = i * 10000;
+        timing::timestamp adjusted = alignment.adjusted( timing::timestamp( t - step ), timing::timestamp( t + jitter( seed, 50 ) ) );
+        if( i > 100 && ( i < 500 || i > 600 ) ) { EXPECT_NEAR( double( t ), double( adjusted.microseconds() ), 50.0 ); }
+    }
+    EXPECT_EQ( 1u, alignment.restarts() );
+    EXPECT_NEAR( 1000000, alignment.offset().total_microseconds(), 50 );
+}
+
+TEST(time, clock_alignment_first)
+{
+    timing::clock_alignment alignment;
+    EXPECT_EQ( timing::timestamp( 1000 ), alignment.to_host( timing::timestamp( 1000 ) ) );
+    EXPECT_EQ( timing::timestamp( 5000 ), alignment.adjusted( timing::timestamp( 1000 ), timing::timestamp( 5000 ) ) );
+    EXPECT_EQ( 4000, alignment.offset().total_microseconds() );
+    EXPECT_EQ( 0, alignment.drift() );
+}
+
 } } // namespace snark { namespace Test {
 
 int main( int argc, char* argv[] )
@@ -0,0 +1,264 @@
+// This file is part of snark, a generic and flexible library for robotics research
+// Copyright (c) 2011 The University of Sydney
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. All advertising materials mentioning features or use of this software
+//    must display the following acknowledgement:
+//    This product includes software developed by the The University of Sydney.
+// 4. Neither the name of the The University of Sydney nor the
+//    names of its contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+//
+// NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+// GRANTED BY THIS LICENSE.  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+// HOLDERS AND CONTRIBUTORS \"AS IS\" AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+// BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+// OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+// IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <cstring>
+#include <limits>
+#include <comma/base/exception.h>
+#include <snark/timing/time.h>
+#include <snark/timing/timestamp.h>
+
+namespace snark{ namespace timing {
+
+static const comma::int64 not_a_date_time = std::numeric_limits< comma::int64 >::min();
+static const comma::int64 neg_infin = std::numeric_limits< comma::int64 >::min() + 1;
+static const comma::int64 pos_infin = std::numeric_limits< comma::int64 >::max();
+static const comma::int64 microseconds_per_second = 1000000;
+static const comma::int64 seconds_per_day = 86400;
+static const char not_a_date_time_string[] = "not-a-date-time";
+static const char neg_infin_string[] = "-infinity";
+static const char pos_infin_string[] = "+infinity";
+static const boost::posix_time::ptime epoch_time( epoch );
+
+// days since epoch for a civil date, proleptic gregorian, see http://howardhinnant.github.io/date_algorithms.html
+static comma::int64 days_from_civil( comma::int64 y, unsigned int m, unsigned int d )
+{
+    y -= m <= 2;
+    const comma::int64 era = ( y >= 0 ? y : y - 399 ) / 400;
+    const unsigned int yoe = static_cast< unsigned int >( y - era * 400 );
+    const unsigned int doy = ( 153 * ( m + ( m > 2 ? -3 : 9 ) ) + 2 ) / 5 + d - 1;
+    const unsigned int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast< comma::int64 >( doe ) - 719468;
+}
+
+static void civil_from_days( comma::int64 z, comma::int64& y, unsigned int& m, unsigned int& d )
+{
+    z += 719468;
+    const comma::int64 era = ( z >= 0 ? z : z - 146096 ) / 146097;
+    const unsigned int doe = static_cast< unsigned int >( z - era * 146097 );
+    const unsigned int yoe = ( doe - doe / 1460 + doe / 36524 - doe / 146096 ) / 365;
+    const unsigned int doy = doe - ( 365 * yoe + yoe / 4 - yoe / 100 );
+    const unsigned int mp = ( 5 * doy + 2 ) / 153;
+    d = doy - ( 153 * mp + 2 ) / 5 + 1;
+    m = mp < 10 ? mp + 3 : mp - 9;
+    y = static_cast< comma::int64 >( yoe ) + era * 400 + ( m <= 2 );
+}
+
+static bool is_leap_year( unsigned int y ) { return y % 4 == 0 && ( y % 100 != 0 || y % 400 == 0 ); }
+
+static unsigned int days_in_month( unsigned int y, unsigned int m )
+{
+    static const unsigned int days[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+    return m == 2 && is_leap_year( y ) ? 29 : days[ m - 1 ];
+}
+
+static comma::int64 floor_divide( comma::int64 a, comma::int64 b ) { return a / b - ( a % b < 0 ); }
+
+static bool is_digit( char c ) { return c >= '0' && c <= '9'; }
+
+// parse exactly n digits; return false if any is not a digit
+static bool digits( const char* p, unsigned int n, unsigned int& value )
+{
+    value = 0;
+    for( unsigned int i = 0; i < n; ++i )
+    {
+        if( !is_digit( p[i] ) ) { return false; }
+        value = value * 10 + ( p[i] - '0' );
+    }
+    return true;
+}
+
+// parse fraction after the decimal point as microseconds; extra digits are ignored
+static bool fraction( const char* p, const char* end, comma::int64& microseconds )
+{
+    if( p == end ) { return false; }
+    microseconds = 0;
+    comma::int64 scale = microseconds_per_second;
+    for( ; p != end; ++p )
+    {
+        if( !is_digit( *p ) ) { return false; }
+        if( scale > 1 ) { scale /= 10; microseconds += ( *p - '0' ) * scale; }
+    }
+    return true;
+}
+
+template < std::size_t N > static bool equals( const char* begin, const char* end, const char ( &s )[N] ) { return std::size_t( end - begin ) == N - 1 && std::memcmp( begin, s, N - 1 ) == 0; }
+
+// parse special value as boost prints it
+static bool special( const char* begin, const char* end, comma::int64& t )
+{
+    if( equals( begin, end, not_a_date_time_string ) ) { t = not_a_date_time; return true; }
+    if( equals( begin, end, pos_infin_string ) ) { t = pos_infin; return true; }
+    if( equals( begin, end, neg_infin_string ) ) { t = neg_infin; return true; }
+    return false;
+}
+
+// write special value as boost prints it, return number of characters written or 0, if not special
+static std::size_t write_special( char* buf, comma::int64 t )
+{
+    switch( t )
+    {
+        case not_a_date_time: std::memcpy( buf, not_a_date_time_string, sizeof( not_a_date_time_string ) - 1 ); return sizeof( not_a_date_time_string ) - 1;
+        case neg_infin: std::memcpy( buf, neg_infin_string, sizeof( neg_infin_string ) - 1 ); return sizeof( neg_infin_string ) - 1;
+        case pos_infin: std::memcpy( buf, pos_infin_string, sizeof( pos_infin_string ) - 1 ); return sizeof( pos_infin_string ) - 1;
+        default: return 0;
+    }
+}
+
+static comma::int64 from_ptime( const boost::posix_time::ptime& t )
+{
+    if( !t.is_special() ) { return ( t - epoch_time ).total_microseconds(); }
+    if( t.is_pos_infinity() ) { return pos_infin; }
+    if( t.is_neg_infinity() ) { return neg_infin; }
+    return not_a_date_time;
+}
+
+static void write_digits( char* p, unsigned int n, comma::uint64 value )
+{
+    for( unsigned int i = n; i > 0; --i ) { p[ i - 1 ] = '0' + value % 10; value /= 10; }
+}
+
+timestamp::timestamp() : m_microseconds( not_a_date_time ) {}
+
+timestamp::timestamp( const boost::posix_time::ptime& t ) : m_microseconds( from_ptime( t ) ) {}
+
+timestamp timestamp::pos_infin() { return timestamp( timing::pos_infin ); }
+
+timestamp timestamp::neg_infin() { return timestamp( timing::neg_infin ); }
+
+boost::posix_time::ptime timestamp::to_ptime() const
+{
+    switch( m_microseconds )
+    {
+        case not_a_date_time: return boost::posix_time::not_a_date_time;
+        case timing::neg_infin: return boost::posix_time::neg_infin;
+        case timing::pos_infin: return boost::posix_time::pos_infin;
+        default: return epoch_time + boost::posix_time::microseconds( m_microseconds );
+    }
+}
+
+bool timestamp::is_not_a_date_time() const { return m_microseconds == not_a_date_time; }
+
+bool timestamp::is_pos_infinity() const { return m_microseconds == timing::pos_infin; }
+
+bool timestamp::is_neg_infinity() const { return m_microseconds == timing::neg_infin; }
+
+bool timestamp::is_special() const { return m_microseconds <= timing::neg_infin || m_microseconds == timing::pos_infin; }
+
+timestamp timestamp::from_iso_string( const char* begin, const char* end )
+{
+    std::size_t size = end - begin;
+    comma::int64 t;
+    if( size > 0 && !is_digit( *begin ) && special( begin, end, t ) ) { return timestamp( t ); }
+    unsigned int year, month, day, hour, minute, second;
+    comma::int64 microseconds = 0;
+    bool ok = size >= 15
+           && digits( begin, 4, year )
+           && digits( begin + 4, 2, month ) && month >= 1 && month <= 12
+           && digits( begin + 6, 2, day ) && day >= 1 && day <= days_in_month( year, month )
+           && begin[8] == 'T'
+           && digits( begin + 9, 2, hour ) && hour < 24
+           && digits( begin + 11, 2, minute ) && minute < 60
+           && digits( begin + 13, 2, second ) && second < 60
+           && ( size == 15 || ( ( begin[15] == '.' || begin[15] == ',' ) && fraction( begin + 16, end, microseconds ) ) );
+    if( !ok ) { COMMA_THROW( comma::exception, "expected iso time as YYYYMMDDTHHMMSS[.ffffff], got \"" << std::string( begin, end ) << "\"" ); }
+    comma::int64 seconds = days_from_civil( year, month, day ) * seconds_per_day + hour * 3600 + minute * 60 + second;
+    return timestamp( seconds * microseconds_per_second + microseconds );
+}
+
+timestamp timestamp::from_iso_string( const std::string& s ) { return from_iso_string( s.data(), s.data() + s.size() ); }
+
+timestamp timestamp::from_epoch_string( const char* begin, const char* end )
+{
+    comma::int64 t;
+    if( special( begin, end, t ) ) { return timestamp( t ); }
+    const char* p = begin;
+    bool negative = p != end && *p == '-';
+    if( negative ) { ++p; }
+    comma::int64 seconds = 0;
+    const char* digits_begin = p;
+    for( ; p != end && is_digit( *p ); ++p ) { seconds = seconds * 10 + ( *p - '0' ); }
+    comma::int64 microseconds = 0;
+    bool ok = p != digits_begin && ( p == end || ( *p == '.' && fraction( p + 1, end, microseconds ) ) );
+    if( !ok ) { COMMA_THROW( comma::exception, "expected seconds since epoch, got \"" << std::string( begin, end ) << "\"" ); }
+    t = seconds * microseconds_per_second + microseconds;
+    return timestamp( negative ? -t : t );
+}
+
+timestamp timestamp::from_epoch_string( const std::string& s ) { return from_epoch_string( s.data(), s.data() + s.size() ); }
+
+std::size_t timestamp::to_iso_string( char* buf ) const
+{
+    if( is_special() ) { return write_special( buf, m_microseconds ); }
+    comma::int64 seconds = floor_divide( m_microseconds, microseconds_per_second );
+    comma::int64 microseconds = m_microseconds - seconds * microseconds_per_second;
+    comma::int64 days = floor_divide( seconds, seconds_per_day );
+    comma::int64 second_of_day = seconds - days * seconds_per_day;
+    comma::int64 year;
+    unsigned int month, day;
+    civil_from_days( days, year, month, day );
+    write_digits( buf, 4, year );
+    write_digits( buf + 4, 2, month );
+    write_digits( buf + 6, 2, day );
+    buf[8] = 'T';
+    write_digits( buf + 9, 2, second_of_day / 3600 );
+    write_digits( buf + 11, 2, second_of_day / 60 % 60 );
+    write_digits( buf + 13, 2, second_of_day % 60 );
+    if( microseconds == 0 ) { return 15; }
+    buf[15] = '.';
+    write_digits( buf + 16, 6, microseconds );
+    return iso_size;
+}
+
+std::string timestamp::to_iso_string() const
+{
+    char buf[ iso_size ];
+    return std::string( buf, to_iso_string( buf ) );
+}
+
+std::string timestamp::to_epoch_string() const
+{
+    char buf[ 32 ];
+    if( is_special() ) { return std::string( buf, write_special( buf, m_microseconds ) ); }
+    char* p = buf + sizeof( buf );
+    bool negative = m_microseconds < 0;
+    comma::uint64 t = negative ? -static_cast< comma::uint64 >( m_microseconds ) : m_microseconds;
+    p -= 6;
+    write_digits( p, 6, t % microseconds_per_second );
+    *--p = '.';
+    t /= microseconds_per_second;
+    do { *--p = '0' + t % 10; t /= 10; } while( t > 0 );
+    if( negative ) { *--p = '-'; }
+    return std::string( p, buf + sizeof( buf ) );
+}
+
+} } // namespace snark{ namespace timing
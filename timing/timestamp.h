@@ -0,0 +1,116 @@
+// This file is part of snark, a generic and flexible library for robotics research
+// Copyright (c) 2011 The University of Sydney
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. All advertising materials mentioning features or use of this software
+//    must display the following acknowledgement:
+//    This product includes software developed by the The University of Sydney.
+// 4. Neither the name of the The University of Sydney nor the
+//    names of its contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+//
+// NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+// GRANTED BY THIS LICENSE.  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+// HOLDERS AND CONTRIBUTORS \"AS IS\" AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+// BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+// OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+// IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef SNARK_TIMING_TIMESTAMP_H_
+#define SNARK_TIMING_TIMESTAMP_H_
+
+#include <string>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <comma/base/types.h>
+
+namespace snark{ namespace timing {
+
+/// compact timestamp: signed microseconds since epoch
+///
+/// cheap to copy, compare and subtract; parses and formats iso and epoch strings
+/// without going through boost::posix_time, for ascii hot loops
+///
+/// special values not-a-date-time, -infinity and +infinity take the lowest and the
+/// highest microseconds, thus compare as in boost, and are kept as they are when shifted
+class timestamp
+{
+    public:
+        /// longest iso string: YYYYMMDDTHHMMSS.ffffff
+        static const std::size_t iso_size = 22;
+
+        /// not-a-date-time
+        timestamp();
+
+        /// microseconds since epoch
+        explicit timestamp( comma::int64 microseconds ) : m_microseconds( microseconds ) {}
+
+        /// from ptime, including special values
+        timestamp( const boost::posix_time::ptime& t );
+
+        /// special values
+        static timestamp pos_infin();
+        static timestamp neg_infin();
+
+        boost::posix_time::ptime to_ptime() const;
+
+        comma::int64 microseconds() const { return m_microseconds; }
+
+        bool is_not_a_date_time() const;
+        bool is_pos_infinity() const;
+        bool is_neg_infinity() const;
+        bool is_special() const;
+
+        /// parse boost iso format YYYYMMDDTHHMMSS[.f], digits of fraction beyond microseconds are ignored, or special value as boost prints it
+        /// @throw comma::exception on anything else
+        static timestamp from_iso_string( const char* begin, const char* end );
+        static timestamp from_iso_string( const std::string& s );
+
+        /// parse seconds since epoch with optional fraction, e.g. 1262304000.123456, or special value as in iso string
+        static timestamp from_epoch_string( const char* begin, const char* end );
+        static timestamp from_epoch_string( const std::string& s );
+
+        /// format as boost::posix_time::to_iso_string() does: fraction only if not zero; special values as in boost
+        /// @param buf at least iso_size characters; not null-terminated
+        /// @return number of characters written
+        std::size_t to_iso_string( char* buf ) const;
+        std::string to_iso_string() const;
+
+        /// format as seconds since epoch with 6 digits of fraction; special values as in iso string
+        std::string to_epoch_string() const;
+
+        bool operator==( const timestamp& rhs ) const { return m_microseconds == rhs.m_microseconds; }
+        bool operator!=( const timestamp& rhs ) const { return m_microseconds != rhs.m_microseconds; }
+        bool operator<( const timestamp& rhs ) const { return m_microseconds < rhs.m_microseconds; }
+        bool operator<=( const timestamp& rhs ) const { return m_microseconds <= rhs.m_microseconds; }
+        bool operator>( const timestamp& rhs ) const { return m_microseconds > rhs.m_microseconds; }
+        bool operator>=( const timestamp& rhs ) const { return m_microseconds >= rhs.m_microseconds; }
+
+        /// shift by given number of microseconds; special values stay as they are
+        timestamp operator+( comma::int64 microseconds ) const { return is_special() ? *this : timestamp( m_microseconds + microseconds ); }
+        timestamp operator-( comma::int64 microseconds ) const { return is_special() ? *this : timestamp( m_microseconds - microseconds ); }
+
+        /// @return difference in microseconds, undefined for special values
+        comma::int64 operator-( const timestamp& rhs ) const { return m_microseconds - rhs.m_microseconds; }
+
+    private:
+        comma::int64 m_microseconds;
+};
+
+} } // namespace snark{ namespace timing
+
+#endif /*SNARK_TIMING_TIMESTAMP_H_*/